@@ -0,0 +1,114 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares each BT node instance creating its own action client with the instances
+// drawing from the ClientPool. Reports the time to create the clients and how long it
+// takes until each of them has discovered the action server
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "example_interfaces/action/fibonacci.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_action/rclcpp_action.hpp"
+#include "ros2_behavior_tree/client_pool.hpp"
+#include "ros2_behavior_tree/node_thread.hpp"
+
+using Clock = std::chrono::steady_clock;
+using Fibonacci = example_interfaces::action::Fibonacci;
+using FibonacciClient = rclcpp_action::Client<Fibonacci>;
+
+// The number of client node instances, such as the ComputePathToPose nodes in the trees
+// of a process
+static const int kNumInstances = 100;
+
+static const char kActionName[] = "fibonacci";
+
+struct Result
+{
+  double create_us{0.0};
+  double discovery_ms{0.0};
+};
+
+template<typename CreateFn>
+static Result
+measure(CreateFn create)
+{
+  std::vector<std::shared_ptr<FibonacciClient>> clients;
+
+  // Create the clients, as the BT nodes would on their first tick
+  auto start = Clock::now();
+  for (int i = 0; i < kNumInstances; i++) {
+    clients.push_back(create());
+  }
+  auto created = Clock::now();
+
+  // Wait for all of them to have discovered the server
+  for (auto & client : clients) {
+    while (!client->action_server_is_ready()) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  }
+  auto discovered = Clock::now();
+
+  Result result;
+  result.create_us = std::chrono::duration<double, std::micro>(created - start).count() /
+    kNumInstances;
+  result.discovery_ms = std::chrono::duration<double, std::milli>(discovered - created).count();
+  return result;
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+
+  // An action server that accepts goals but is never sent any
+  auto server_node = std::make_shared<rclcpp::Node>("benchmark_client_pool_server");
+  auto server = rclcpp_action::create_server<Fibonacci>(server_node, kActionName,
+      [](const rclcpp_action::GoalUUID &, std::shared_ptr<const Fibonacci::Goal>) {
+        return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+      },
+      [](const std::shared_ptr<rclcpp_action::ServerGoalHandle<Fibonacci>>) {
+        return rclcpp_action::CancelResponse::ACCEPT;
+      },
+      [](const std::shared_ptr<rclcpp_action::ServerGoalHandle<Fibonacci>>) {});
+  auto server_thread = std::make_unique<ros2_behavior_tree::NodeThread>(server_node);
+
+  auto client_node = std::make_shared<rclcpp::Node>("benchmark_client_pool_client");
+  auto client_thread = std::make_unique<ros2_behavior_tree::NodeThread>(client_node);
+
+  Result own = measure([&]() {
+        return rclcpp_action::create_client<Fibonacci>(client_node, kActionName);
+      });
+
+  Result pooled = measure([&]() {
+        return ros2_behavior_tree::ClientPool::instance().get_action_client<Fibonacci>(
+          client_node, kActionName);
+      });
+
+  printf("%d client node instances\n", kNumInstances);
+  printf("%-28s %14s %18s\n", "", "create (us/node)", "discovery (ms)");
+  printf("%-28s %14.1f %18.1f\n", "client per node", own.create_us, own.discovery_ms);
+  printf("%-28s %14.1f %18.1f\n", "ClientPool", pooled.create_us, pooled.discovery_ms);
+  printf("clients created by the pool: %lu\n",
+    static_cast<unsigned long>(ros2_behavior_tree::ClientPool::instance().created()));
+
+  client_thread.reset();
+  server_thread.reset();
+  rclcpp::shutdown();
+  return 0;
+}
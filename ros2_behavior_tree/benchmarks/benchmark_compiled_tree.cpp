@@ -0,0 +1,114 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the time to create a ready-to-run tree from XML (parse and instantiate) with
+// loading the same tree from a compiled tree file
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "rclcpp/rclcpp.hpp"
+#include "ros2_behavior_tree/behavior_tree.hpp"
+#include "ros2_behavior_tree/compiled_tree.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static const int kNumBranches = 100;
+static const int kNumIterations = 50;
+
+// A tree with a few hundred nodes, with both literal and remapped ports
+static std::string
+make_bt_xml()
+{
+  std::string xml =
+    R"(<root main_tree_to_execute="MainTree"><BehaviorTree ID="MainTree"><Sequence name="root">)";
+
+  for (int i = 0; i < kNumBranches; i++) {
+    auto n = std::to_string(i);
+    xml += R"(<Fallback name="branch_)" + n + R"(">)";
+    xml += R"(<Recovery num_retries="2"><AlwaysFailure/><AlwaysSuccess/></Recovery>)";
+    xml += R"(<ThrottleTickRate hz="{rate_)" + n + R"(}"><AlwaysSuccess/></ThrottleTickRate>)";
+    xml += R"(<Repeat num_cycles="3"><AlwaysSuccess/></Repeat>)";
+    xml += R"(</Fallback>)";
+  }
+
+  xml += R"(</Sequence></BehaviorTree></root>)";
+  return xml;
+}
+
+static double
+elapsed_us(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+
+  const std::string bt_xml = make_bt_xml();
+  const std::string filename = "/tmp/benchmark_compiled_tree.btc";
+
+  // Compile the tree, as the compile_behavior_tree tool would
+  size_t node_count;
+  {
+    ros2_behavior_tree::BehaviorTree bt(bt_xml);
+    bt.prepare();
+    node_count = bt.tree()->nodes.size();
+
+    std::string compiled = ros2_behavior_tree::CompiledTree::compile(*bt.tree());
+    std::ofstream(filename, std::ios::binary).write(compiled.data(), compiled.size());
+    printf("%zu nodes, %zu bytes of XML, %zu bytes compiled\n",
+      node_count, bt_xml.size(), compiled.size());
+  }
+
+  // Parse the XML and instantiate the tree
+  double total_us = 0.0;
+  for (int i = 0; i < kNumIterations; i++) {
+    auto start = Clock::now();
+    ros2_behavior_tree::BehaviorTree bt(bt_xml);
+    bt.prepare();
+    total_us += elapsed_us(start);
+  }
+  printf("%-36s %10.1f us/tree\n", "XML parse + instantiate", total_us / kNumIterations);
+
+  // Map the compiled file and instantiate the tree
+  total_us = 0.0;
+  for (int i = 0; i < kNumIterations; i++) {
+    auto start = Clock::now();
+    auto compiled_tree = std::make_shared<ros2_behavior_tree::CompiledTree>(filename);
+    ros2_behavior_tree::BehaviorTree bt(compiled_tree);
+    bt.prepare();
+    total_us += elapsed_us(start);
+  }
+  printf("%-36s %10.1f us/tree\n", "compiled load + instantiate", total_us / kNumIterations);
+
+  // Instantiate from a compiled tree that was mapped once
+  auto shared_compiled_tree = std::make_shared<ros2_behavior_tree::CompiledTree>(filename);
+  total_us = 0.0;
+  for (int i = 0; i < kNumIterations; i++) {
+    auto start = Clock::now();
+    ros2_behavior_tree::BehaviorTree bt(shared_compiled_tree);
+    bt.prepare();
+    total_us += elapsed_us(start);
+  }
+  printf("%-36s %10.1f us/tree\n", "shared compiled tree, instantiate", total_us / kNumIterations);
+
+  std::remove(filename.c_str());
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,150 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the memory used by the coroutine stacks of 1000 client nodes with
+// BT::CoroActionNode and with PooledCoroActionNode. Reports the growth of the resident set
+// while all of the nodes are waiting on a response, as in a tree with many clients in
+// parallel, and the time and stacks needed to re-instantiate the nodes for each goal when
+// they run one after another, as in a sequence
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "behaviortree_cpp_v3/action_node.h"
+#include "ros2_behavior_tree/coroutine_stack_pool.hpp"
+#include "ros2_behavior_tree/pooled_coro_action_node.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static const int kNumNodes = 1000;
+static const int kNumGoals = 20;
+
+// The stack a client node uses before it yields, for the frames of the ROS2 calls
+static const int kStackUse = 8 * 1024;
+
+// Stands in for a client node: sends a request, yields until the response arrives on the
+// next tick and then succeeds
+template<typename BaseT>
+class ClientLikeNode : public BaseT
+{
+public:
+  explicit ClientLikeNode(const std::string & name)
+  : BaseT(name, {})
+  {
+  }
+
+  BT::NodeStatus tick() override
+  {
+    volatile char frames[kStackUse];
+    for (int i = 0; i < kStackUse; i += 512) {
+      frames[i] = 1;
+    }
+
+    this->setStatusRunningAndYield();
+    return frames[0] == 1 ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
+  }
+};
+
+static double
+resident_mb()
+{
+  std::ifstream statm("/proc/self/statm");
+  long size = 0, resident = 0;
+  statm >> size >> resident;
+  return static_cast<double>(resident) * sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+}
+
+struct Result
+{
+  double waiting_rss_mb{0.0};
+  double goal_ms{0.0};
+};
+
+template<typename BaseT>
+static Result
+measure()
+{
+  using Node = ClientLikeNode<BaseT>;
+  Result result;
+
+  // All of the nodes waiting on a response at the same time
+  {
+    std::vector<std::unique_ptr<Node>> nodes;
+    for (int i = 0; i < kNumNodes; i++) {
+      nodes.push_back(std::make_unique<Node>("client"));
+    }
+
+    double before = resident_mb();
+    for (auto & node : nodes) {
+      node->executeTick();
+    }
+    result.waiting_rss_mb = resident_mb() - before;
+
+    for (auto & node : nodes) {
+      node->executeTick();
+    }
+  }
+
+  // The nodes re-instantiated for each goal and run one after another
+  auto start = Clock::now();
+  for (int goal = 0; goal < kNumGoals; goal++) {
+    std::vector<std::unique_ptr<Node>> nodes;
+    for (int i = 0; i < kNumNodes; i++) {
+      nodes.push_back(std::make_unique<Node>("client"));
+    }
+
+    for (auto & node : nodes) {
+      while (node->executeTick() == BT::NodeStatus::RUNNING) {
+      }
+    }
+  }
+  result.goal_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() /
+    kNumGoals;
+
+  return result;
+}
+
+int main()
+{
+  auto & pool = ros2_behavior_tree::CoroutineStackPool::instance();
+
+  // The pooled stacks are mapped separately from the heap, so measure them first, before
+  // the heap has grown
+  ros2_behavior_tree::CoroutineStackPool::Options small;
+  small.stack_size = 64 * 1024;
+  pool.configure(small);
+  Result pooled_small = measure<ros2_behavior_tree::PooledCoroActionNode>();
+
+  pool.configure(ros2_behavior_tree::CoroutineStackPool::Options());
+  Result pooled = measure<ros2_behavior_tree::PooledCoroActionNode>();
+
+  Result coro = measure<BT::CoroActionNode>();
+
+  printf("%d client nodes, %d goals\n", kNumNodes, kNumGoals);
+  printf("%-34s %16s %14s\n", "", "waiting RSS (MB)", "goal (ms)");
+  printf("%-34s %16.1f %14.2f\n", "BT::CoroActionNode", coro.waiting_rss_mb, coro.goal_ms);
+  printf("%-34s %16.1f %14.2f\n", "PooledCoroActionNode (256 KiB)", pooled.waiting_rss_mb,
+    pooled.goal_ms);
+  printf("%-34s %16.1f %14.2f\n", "PooledCoroActionNode (64 KiB)", pooled_small.waiting_rss_mb,
+    pooled_small.goal_ms);
+  printf("stacks mapped by the pool: %lu, reused: %lu\n",
+    static_cast<unsigned long>(pool.created()), static_cast<unsigned long>(pool.reused()));
+  return 0;
+}
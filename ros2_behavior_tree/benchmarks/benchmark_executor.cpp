@@ -0,0 +1,155 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares running many concurrent trees on a thread each (as the sample action servers
+// used to do) with running them on a BehaviorTreeExecutor. Reports the number of threads
+// in the process and how late the trees were ticked
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "ros2_behavior_tree/behavior_tree.hpp"
+#include "ros2_behavior_tree/behavior_tree_executor.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// A tree that runs until it is halted
+static const char bt_xml[] =
+  R"(
+<root main_tree_to_execute="MainTree">
+  <BehaviorTree ID="MainTree">
+    <Forever>
+      <Sequence>
+        <AlwaysSuccess/>
+        <AlwaysSuccess/>
+      </Sequence>
+    </Forever>
+  </BehaviorTree>
+</root>
+)";
+
+static const int kNumTrees = 200;
+static const int kNumTicks = 50;
+static const std::chrono::milliseconds kTickPeriod(10);
+
+// The number of threads in this process
+static int
+thread_count()
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 8, "Threads:") == 0) {
+      return std::stoi(line.substr(8));
+    }
+  }
+  return -1;
+}
+
+static std::vector<std::shared_ptr<ros2_behavior_tree::BehaviorTree>>
+create_trees()
+{
+  std::vector<std::shared_ptr<ros2_behavior_tree::BehaviorTree>> trees;
+  for (int i = 0; i < kNumTrees; i++) {
+    auto bt = std::make_shared<ros2_behavior_tree::BehaviorTree>(bt_xml);
+    bt->set_console_logging(false);
+    bt->prepare();
+    trees.push_back(bt);
+  }
+  return trees;
+}
+
+static void
+report(
+  const char * label, const std::vector<std::shared_ptr<ros2_behavior_tree::BehaviorTree>> & trees,
+  int max_threads, Clock::duration elapsed)
+{
+  uint64_t p50 = 0, p99 = 0;
+  for (const auto & bt : trees) {
+    p50 += bt->tick_statistics().wakeup_jitter.percentile(0.5);
+    p99 = std::max(p99, bt->tick_statistics().wakeup_jitter.percentile(0.99));
+  }
+
+  printf("%-24s threads %5d  elapsed %8.1f ms  jitter p50 %8.1f us  worst p99 %8.1f us\n",
+    label, max_threads, std::chrono::duration<double, std::milli>(elapsed).count(),
+    p50 / 1e3 / trees.size(), p99 / 1e3);
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+
+  // One thread per tree
+  {
+    auto trees = create_trees();
+    std::vector<std::thread> threads;
+    std::atomic<int> max_threads{0};
+
+    auto start = Clock::now();
+    for (auto & bt : trees) {
+      threads.emplace_back(
+        [&bt, &max_threads]() {
+          int ticks = 0;
+          bt->execute([&ticks]() {return ticks >= kNumTicks;},
+          [&ticks, &max_threads]() {
+            if (++ticks == 1) {
+              int count = thread_count();
+              int current = max_threads.load();
+              while (count > current && !max_threads.compare_exchange_weak(current, count)) {
+              }
+            }
+          },
+          kTickPeriod);
+        });
+    }
+    for (auto & thread : threads) {
+      thread.join();
+    }
+    report("thread per tree", trees, max_threads, Clock::now() - start);
+  }
+
+  // All trees on an executor
+  {
+    auto trees = create_trees();
+    ros2_behavior_tree::BehaviorTreeExecutor executor;
+    std::atomic<int> remaining{kNumTrees};
+    int max_threads = 0;
+
+    auto start = Clock::now();
+    for (auto & bt : trees) {
+      auto ticks = std::make_shared<int>(0);
+      ros2_behavior_tree::BehaviorTreeExecutor::Options options;
+      options.tick_period = kTickPeriod;
+      options.should_halt = [ticks]() {return *ticks >= kNumTicks;};
+      options.on_loop_iteration = [ticks]() {(*ticks)++;};
+      executor.submit(bt, [&remaining](ros2_behavior_tree::BtStatus) {remaining--;}, options);
+    }
+    while (remaining > 0) {
+      max_threads = std::max(max_threads, thread_count());
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    report("executor", trees, max_threads, Clock::now() - start);
+  }
+
+  rclcpp::shutdown();
+  return 0;
+}
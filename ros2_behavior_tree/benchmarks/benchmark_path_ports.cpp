@@ -0,0 +1,160 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures moving a 10,000 pose path from a ComputePathToPose result, through the
+// blackboard, to a FollowPath goal and then checking it for changes on each tick. Compares
+// passing nav_msgs::msg::Path by value with passing std::shared_ptr<const Path>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "behaviortree_cpp_v3/action_node.h"
+#include "behaviortree_cpp_v3/behavior_tree.h"
+#include "nav2_msgs/action/compute_path_to_pose.hpp"
+#include "nav2_msgs/action/follow_path.hpp"
+#include "ros2_behavior_tree/port_binding.hpp"
+#include "ros2_behavior_tree/shared_message.hpp"
+
+using Clock = std::chrono::steady_clock;
+using Path = nav_msgs::msg::Path;
+using PathPtr = std::shared_ptr<const Path>;
+
+static const int kNumPoses = 10000;
+static const int kNumHops = 200;
+static const int kTicksPerHop = 50;
+
+// A node with a path output and input, standing in for ComputePathToPose and FollowPath
+template<typename PathT>
+class PathPortsNode : public BT::SyncActionNode
+{
+public:
+  PathPortsNode(const std::string & name, const BT::NodeConfiguration & config)
+  : BT::SyncActionNode(name, config),
+    path_output_(*this, "path_out"),
+    path_input_(*this, "path_in")
+  {
+  }
+
+  static BT::PortsList providedPorts()
+  {
+    return {
+      BT::OutputPort<PathT>("path_out"),
+      BT::InputPort<PathT>("path_in")
+    };
+  }
+
+  BT::NodeStatus tick() override
+  {
+    return BT::NodeStatus::SUCCESS;
+  }
+
+  ros2_behavior_tree::OutputBinding<PathT> path_output_;
+  ros2_behavior_tree::InputBinding<PathT> path_input_;
+};
+
+template<typename PathT>
+static std::unique_ptr<PathPortsNode<PathT>>
+create_node()
+{
+  BT::NodeConfiguration config;
+  config.blackboard = BT::Blackboard::create();
+  config.output_ports["path_out"] = "{path}";
+  config.input_ports["path_in"] = "{path}";
+  return std::make_unique<PathPortsNode<PathT>>("node", config);
+}
+
+static std::shared_ptr<nav2_msgs::action::ComputePathToPose::Result>
+create_result()
+{
+  auto result = std::make_shared<nav2_msgs::action::ComputePathToPose::Result>();
+  result->path.header.frame_id = "map";
+  result->path.poses.resize(kNumPoses);
+  for (int i = 0; i < kNumPoses; i++) {
+    result->path.poses[i].pose.position.x = 0.01 * i;
+  }
+  return result;
+}
+
+static void
+report(const char * label, Clock::duration hop_time, Clock::duration check_time)
+{
+  printf("%-28s %12.1f %18.3f\n", label,
+    std::chrono::duration<double, std::micro>(hop_time).count() / kNumHops,
+    std::chrono::duration<double, std::micro>(check_time).count() / (kNumHops * kTicksPerHop));
+}
+
+int main()
+{
+  printf("%d poses per path\n", kNumPoses);
+  printf("%-28s %12s %18s\n", "", "hop (us)", "check (us/tick)");
+
+  // By value: the path is copied to the blackboard, copied out into the goal, and copied
+  // and compared with the goal on each check for a new goal
+  {
+    auto node = create_node<Path>();
+    Clock::duration hop_time{0}, check_time{0};
+    for (int hop = 0; hop < kNumHops; hop++) {
+      auto result = create_result();
+      nav2_msgs::action::FollowPath::Goal goal;
+
+      auto start = Clock::now();
+      node->path_output_.set(result->path);
+      node->path_input_.get(goal.path);
+      hop_time += Clock::now() - start;
+
+      start = Clock::now();
+      for (int tick = 0; tick < kTicksPerHop; tick++) {
+        Path path;
+        node->path_input_.get(path);
+        if (path != goal.path) {
+          goal.path = path;
+        }
+      }
+      check_time += Clock::now() - start;
+    }
+    report("nav_msgs::msg::Path", hop_time, check_time);
+  }
+
+  // Shared: the path stays in the result; only the goal gets a copy, and a check compares
+  // versions
+  {
+    auto node = create_node<PathPtr>();
+    Clock::duration hop_time{0}, check_time{0};
+    for (int hop = 0; hop < kNumHops; hop++) {
+      auto result = create_result();
+      nav2_msgs::action::FollowPath::Goal goal;
+
+      auto start = Clock::now();
+      node->path_output_.set(ros2_behavior_tree::share_member(result, result->path));
+      PathPtr path;
+      uint64_t version = node->path_input_.version();
+      node->path_input_.get(path);
+      goal.path = *path;
+      hop_time += Clock::now() - start;
+
+      start = Clock::now();
+      for (int tick = 0; tick < kTicksPerHop; tick++) {
+        if (node->path_input_.get_if_changed(path, version)) {
+          goal.path = *path;
+        }
+      }
+      check_time += Clock::now() - start;
+    }
+    report("std::shared_ptr<const Path>", hop_time, check_time);
+  }
+
+  return 0;
+}
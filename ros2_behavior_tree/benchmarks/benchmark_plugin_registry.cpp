@@ -0,0 +1,96 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares loading the BT plugin libraries into each new factory with populating the
+// factory from the process-wide PluginRegistry, both at startup and per goal
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "behaviortree_cpp_v3/bt_factory.h"
+#include "ros2_behavior_tree/behavior_tree.hpp"
+#include "ros2_behavior_tree/plugin_registry.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static const char bt_xml[] =
+  R"(
+<root main_tree_to_execute="MainTree">
+  <BehaviorTree ID="MainTree">
+    <Sequence name="say_hello">
+      <Message msg="Hello,"/>
+      <Message msg="World!"/>
+    </Sequence>
+  </BehaviorTree>
+</root>
+)";
+
+static const std::vector<std::string> plugins = {"ros2_behavior_tree_nodes"};
+static const int kNumGoals = 500;
+
+template<typename Fn>
+static double
+time_us(Fn fn)
+{
+  auto start = Clock::now();
+  fn();
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+int main(int /*argc*/, char ** /*argv*/)
+{
+  // Startup: the first load of the plugins in the process
+  double startup_us = time_us([]() {
+        BT::BehaviorTreeFactory factory;
+        for (const auto & plugin : plugins) {
+          ros2_behavior_tree::PluginRegistry::instance().register_nodes(factory, plugin);
+        }
+      });
+  printf("%-40s %10.1f us\n", "registry startup (first load)", startup_us);
+
+  // Per goal, going through the dynamic loader for each new factory
+  double total_us = 0.0;
+  for (int i = 0; i < kNumGoals; i++) {
+    total_us += time_us([]() {
+          BT::BehaviorTreeFactory factory;
+          for (const auto & plugin : plugins) {
+            factory.registerFromPlugin(std::string{"lib" + plugin + ".so"});
+          }
+        });
+  }
+  printf("%-40s %10.1f us/goal\n", "factory, registerFromPlugin", total_us / kNumGoals);
+
+  // Per goal, cloning the cached manifests into each new factory
+  total_us = 0.0;
+  for (int i = 0; i < kNumGoals; i++) {
+    total_us += time_us([]() {
+          BT::BehaviorTreeFactory factory;
+          for (const auto & plugin : plugins) {
+            ros2_behavior_tree::PluginRegistry::instance().register_nodes(factory, plugin);
+          }
+        });
+  }
+  printf("%-40s %10.1f us/goal\n", "factory, PluginRegistry", total_us / kNumGoals);
+
+  // Per goal, constructing a complete BehaviorTree (which uses the registry)
+  total_us = 0.0;
+  for (int i = 0; i < kNumGoals; i++) {
+    total_us += time_us([]() {ros2_behavior_tree::BehaviorTree bt(bt_xml, plugins);});
+  }
+  printf("%-40s %10.1f us/goal\n", "BehaviorTree construction", total_us / kNumGoals);
+
+  return 0;
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the per-tick cost of reading and writing ports with getInput/setOutput,
+// compared with port bindings that are resolved once when the node is created
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "behaviortree_cpp_v3/action_node.h"
+#include "behaviortree_cpp_v3/behavior_tree.h"
+#include "ros2_behavior_tree/port_binding.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static const int kNumIterations = 1000000;
+
+class PortAccessNode : public BT::SyncActionNode
+{
+public:
+  PortAccessNode(const std::string & name, const BT::NodeConfiguration & config)
+  : BT::SyncActionNode(name, config),
+    threshold_input_(*this, "threshold"),
+    frame_input_(*this, "frame"),
+    result_output_(*this, "result")
+  {
+  }
+
+  static BT::PortsList providedPorts()
+  {
+    return {
+      BT::InputPort<double>("threshold"),
+      BT::InputPort<std::string>("frame"),
+      BT::OutputPort<double>("result")
+    };
+  }
+
+  BT::NodeStatus tick() override
+  {
+    return BT::NodeStatus::SUCCESS;
+  }
+
+  ros2_behavior_tree::InputBinding<double> threshold_input_;
+  ros2_behavior_tree::InputBinding<std::string> frame_input_;
+  ros2_behavior_tree::OutputBinding<double> result_output_;
+};
+
+template<typename F>
+static void
+measure(const char * label, F && access)
+{
+  auto start = Clock::now();
+  for (int i = 0; i < kNumIterations; i++) {
+    access(i);
+  }
+  double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  printf("%-36s %8.1f ns/access\n", label, ns / kNumIterations);
+}
+
+int main()
+{
+  auto blackboard = BT::Blackboard::create();
+  blackboard->set<double>("threshold", 0.5);
+  blackboard->set<std::string>("frame", "base_link");
+
+  BT::NodeConfiguration config;
+  config.blackboard = blackboard;
+  config.input_ports["threshold"] = "{threshold}";
+  config.input_ports["frame"] = "{frame}";
+  config.output_ports["result"] = "{result}";
+
+  PortAccessNode node("node", config);
+
+  double threshold;
+  std::string frame;
+
+  measure("getInput<double>", [&](int) {node.getInput<double>("threshold", threshold);});
+  measure("InputBinding<double>::get", [&](int) {node.threshold_input_.get(threshold);});
+
+  measure("getInput<std::string>", [&](int) {node.getInput<std::string>("frame", frame);});
+  measure("InputBinding<std::string>::get", [&](int) {node.frame_input_.get(frame);});
+
+  measure("setOutput<double>", [&](int i) {node.setOutput<double>("result", i);});
+  measure("OutputBinding<double>::set", [&](int i) {node.result_output_.set(i);});
+
+  return 0;
+}
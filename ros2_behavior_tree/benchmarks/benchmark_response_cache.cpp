@@ -0,0 +1,106 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures calling the AddTwoInts test service through the AddTwoInts client node, with and
+// without the ResponseCache. The requests cycle through a few distinct values, as a tree
+// querying a service over and over would
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "add_two_ints_client.hpp"
+#include "add_two_ints_server.hpp"
+#include "behaviortree_cpp_v3/behavior_tree.h"
+#include "rclcpp/rclcpp.hpp"
+#include "ros2_behavior_tree/node_thread.hpp"
+#include "ros2_behavior_tree/response_cache.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static const int kNumCalls = 2000;
+static const int kNumDistinctRequests = 4;
+
+// Call the service through the node until the call completes, returning its duration
+static double
+call_us(AddTwoIntsClient & client)
+{
+  auto start = Clock::now();
+  auto status = client.executeTick();
+  while (status == BT::NodeStatus::RUNNING) {
+    std::this_thread::yield();
+    status = client.executeTick();
+  }
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+static double
+measure(const rclcpp::Node::SharedPtr & node, const std::string & cache_ttl)
+{
+  auto blackboard = BT::Blackboard::create();
+  BT::NodeConfiguration config;
+  config.blackboard = blackboard;
+  BT::assignDefaultRemapping<AddTwoIntsClient>(config);
+
+  blackboard->set("service_name", "add_two_ints");
+  blackboard->set("server_timeout", "1000");
+  blackboard->set<std::shared_ptr<rclcpp::Node>>("ros2_node", node);  // NOLINT
+  blackboard->set("a", 1);
+  if (!cache_ttl.empty()) {
+    blackboard->set("cache_ttl", cache_ttl);
+  }
+
+  AddTwoIntsClient client("add_two_ints", config);
+
+  double total_us = 0.0;
+  for (int i = 0; i < kNumCalls; i++) {
+    blackboard->set("b", i % kNumDistinctRequests);
+    total_us += call_us(client);
+  }
+  return total_us / kNumCalls;
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+
+  auto server_node = std::make_shared<AddTwoIntsServer>("benchmark_response_cache_server");
+  auto server_thread = std::make_unique<ros2_behavior_tree::NodeThread>(server_node);
+
+  auto client_node = std::make_shared<rclcpp::Node>("benchmark_response_cache_client");
+  auto client_thread = std::make_unique<ros2_behavior_tree::NodeThread>(client_node);
+
+  // Make sure the server has been discovered before timing anything
+  measure(client_node, "");
+
+  double uncached_us = measure(client_node, "");
+  double cached_us = measure(client_node, "500");
+  auto statistics = ros2_behavior_tree::ResponseCache::instance().statistics();
+
+  printf("%d calls, %d distinct requests\n", kNumCalls, kNumDistinctRequests);
+  printf("%-24s %14s\n", "", "call (us)");
+  printf("%-24s %14.1f\n", "no cache", uncached_us);
+  printf("%-24s %14.1f\n", "cache_ttl=500", cached_us);
+  printf("cache hits: %lu, misses: %lu, expirations: %lu, size: %lu\n",
+    static_cast<unsigned long>(statistics.hits), static_cast<unsigned long>(statistics.misses),
+    static_cast<unsigned long>(statistics.expirations),
+    static_cast<unsigned long>(statistics.size));
+
+  client_thread.reset();
+  server_thread.reset();
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,151 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares spinning each ROS2 node on a NodeThread of its own with spinning all of them
+// on the ExecutorService, for the nodes of a multi-robot tree that are mostly idle. Each
+// node has a slow timer standing in for its occasional callbacks. Reports the threads in
+// the process, the context switches and the CPU time used over a fixed period
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "ros2_behavior_tree/executor_service.hpp"
+#include "ros2_behavior_tree/node_thread.hpp"
+
+// The number of nodes, such as those created by CreateROS2Node for each robot
+static const int kNumNodes = 32;
+
+static const std::chrono::milliseconds kTimerPeriod(100);
+static const std::chrono::seconds kMeasurePeriod(5);
+
+// The number of threads of the ExecutorService
+static const size_t kServiceThreads = 2;
+
+struct Result
+{
+  int threads{0};
+  long context_switches{0};
+  double cpu_ms{0.0};
+  unsigned long callbacks{0};
+};
+
+static int
+count_threads()
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 8, "Threads:") == 0) {
+      return std::stoi(line.substr(8));
+    }
+  }
+  return 0;
+}
+
+static double
+to_ms(const timeval & time)
+{
+  return time.tv_sec * 1000.0 + time.tv_usec / 1000.0;
+}
+
+template<typename SpinT>
+static Result
+measure(const std::string & name)
+{
+  std::vector<rclcpp::Node::SharedPtr> nodes;
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  std::atomic<unsigned long> callbacks{0};
+
+  for (int i = 0; i < kNumNodes; i++) {
+    auto node = std::make_shared<rclcpp::Node>(name + "_" + std::to_string(i));
+    timers.push_back(node->create_wall_timer(kTimerPeriod, [&callbacks]() {callbacks++;}));
+    nodes.push_back(node);
+  }
+
+  std::vector<decltype(SpinT::spin(nullptr))> spinning;
+  for (auto & node : nodes) {
+    spinning.push_back(SpinT::spin(node));
+  }
+
+  // Let the threads settle before measuring
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  rusage before;
+  getrusage(RUSAGE_SELF, &before);
+  unsigned long callbacks_before = callbacks;
+
+  std::this_thread::sleep_for(kMeasurePeriod);
+
+  rusage after;
+  getrusage(RUSAGE_SELF, &after);
+
+  Result result;
+  result.threads = count_threads();
+  result.context_switches = (after.ru_nvcsw - before.ru_nvcsw) +
+    (after.ru_nivcsw - before.ru_nivcsw);
+  result.cpu_ms = (to_ms(after.ru_utime) - to_ms(before.ru_utime)) +
+    (to_ms(after.ru_stime) - to_ms(before.ru_stime));
+  result.callbacks = callbacks - callbacks_before;
+
+  spinning.clear();
+  return result;
+}
+
+struct ThreadPerNode
+{
+  static std::unique_ptr<ros2_behavior_tree::NodeThread> spin(rclcpp::Node::SharedPtr node)
+  {
+    return std::make_unique<ros2_behavior_tree::NodeThread>(node);
+  }
+};
+
+struct SharedExecutor
+{
+  static std::unique_ptr<ros2_behavior_tree::ExecutorService::Registration> spin(
+    rclcpp::Node::SharedPtr node)
+  {
+    return ros2_behavior_tree::ExecutorService::instance().add_node(node);
+  }
+};
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+
+  ros2_behavior_tree::ExecutorService::instance().set_thread_count(kServiceThreads);
+
+  Result own = measure<ThreadPerNode>("benchmark_spin_threads_own");
+  Result shared = measure<SharedExecutor>("benchmark_spin_threads_shared");
+
+  printf("%d nodes, each with a %ld ms timer, over %ld s\n", kNumNodes,
+    static_cast<long>(kTimerPeriod.count()), static_cast<long>(kMeasurePeriod.count()));
+  printf("%-28s %8s %18s %10s %10s\n", "", "threads", "context switches", "CPU (ms)",
+    "callbacks");
+  printf("%-28s %8d %18ld %10.1f %10lu\n", "NodeThread per node", own.threads,
+    own.context_switches, own.cpu_ms, own.callbacks);
+  printf("%-28s %8d %18ld %10.1f %10lu\n", "ExecutorService", shared.threads,
+    shared.context_switches, shared.cpu_ms, shared.callbacks);
+
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,119 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the goal-to-first-tick latency of a Behavior Tree, comparing a tree that is
+// created for each goal (as the sample action servers used to do) with a tree that is
+// instantiated once and reused
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "rclcpp/rclcpp.hpp"
+#include "ros2_behavior_tree/behavior_tree.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static const char bt_xml[] =
+  R"(
+<root main_tree_to_execute="MainTree">
+  <BehaviorTree ID="MainTree">
+    <Sequence name="root">
+      <Repeat num_cycles="1">
+        <Sequence>
+          <AlwaysSuccess/>
+          <AlwaysSuccess/>
+          <AlwaysSuccess/>
+          <AlwaysSuccess/>
+        </Sequence>
+      </Repeat>
+      <Fallback>
+        <AlwaysFailure/>
+        <AlwaysSuccess/>
+      </Fallback>
+      <RoundRobin>
+        <AlwaysSuccess/>
+        <AlwaysSuccess/>
+      </RoundRobin>
+      <Recovery num_retries="1">
+        <AlwaysSuccess/>
+        <AlwaysSuccess/>
+      </Recovery>
+    </Sequence>
+  </BehaviorTree>
+</root>
+)";
+
+static const int kNumGoals = 200;
+
+// Executes the tree, returning the time from the start of the goal to the first tick
+static double
+run_goal(ros2_behavior_tree::BehaviorTree & bt, Clock::time_point goal_start)
+{
+  Clock::time_point first_tick;
+  bool ticked = false;
+
+  bt.execute([]() {return false;},
+    [&]() {
+      if (!ticked) {
+        first_tick = Clock::now();
+        ticked = true;
+      }
+    },
+    std::chrono::milliseconds(1));
+
+  return std::chrono::duration<double, std::micro>(first_tick - goal_start).count();
+}
+
+static void
+report(const char * label, double total_us)
+{
+  printf("%-32s %10.1f us/goal\n", label, total_us / kNumGoals);
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+
+  // A new BehaviorTree for each goal: parse, instantiate and tick
+  double total_us = 0.0;
+  for (int i = 0; i < kNumGoals; i++) {
+    auto goal_start = Clock::now();
+    ros2_behavior_tree::BehaviorTree bt(bt_xml);
+    total_us += run_goal(bt, goal_start);
+  }
+  report("new tree per goal", total_us);
+
+  // A single BehaviorTree, re-instantiated on each goal
+  ros2_behavior_tree::BehaviorTree no_reuse_bt(bt_xml);
+  no_reuse_bt.set_reuse_tree(false);
+  total_us = 0.0;
+  for (int i = 0; i < kNumGoals; i++) {
+    total_us += run_goal(no_reuse_bt, Clock::now());
+  }
+  report("re-instantiated per goal", total_us);
+
+  // A single BehaviorTree, instantiated once and reset between goals
+  ros2_behavior_tree::BehaviorTree reuse_bt(bt_xml);
+  reuse_bt.prepare();
+  total_us = 0.0;
+  for (int i = 0; i < kNumGoals; i++) {
+    total_us += run_goal(reuse_bt, Clock::now());
+  }
+  report("prepared tree, reset per goal", total_us);
+
+  rclcpp::shutdown();
+  return 0;
+}
@@ -20,6 +20,8 @@
 #include "rclcpp_action/rclcpp_action.hpp"
 #include "rclcpp_lifecycle/lifecycle_node.hpp"
 #include "ros2_behavior_tree/behavior_tree.hpp"
+#include "ros2_behavior_tree/behavior_tree_executor.hpp"
+#include "ros2_behavior_tree/behavior_tree_pool.hpp"
 #include "ros2_behavior_tree_msgs/action/print_message.hpp"
 
 namespace ros2_behavior_tree
@@ -59,11 +61,18 @@ protected:
   void handle_accepted(
     const std::shared_ptr<GoalHandle> goal_handle);
 
-  // The action server routine
+  // Start a Behavior Tree for the goal, and report the result once the tree completes
   void print_message(const std::shared_ptr<GoalHandle> goal_handle);
+  void complete_goal(const std::shared_ptr<GoalHandle> goal_handle, BtStatus status);
 
   // The XML string that defines the Behavior Tree used to implement the printMessage action
   static const char bt_xml_[];
+
+  // Ready-to-run trees, so that each goal doesn't have to parse and instantiate its own
+  BehaviorTreePool bt_pool_;
+
+  // Ticks the trees of all of the active goals on a few shared threads
+  BehaviorTreeExecutor bt_executor_;
 };
 
 }  // namespace ros2_behavior_tree
@@ -38,7 +38,7 @@ const char SampleActionServerNode::bt_xml_[] =
 )";
 
 SampleActionServerNode::SampleActionServerNode()
-: Node("sample_action_server_node")
+: Node("sample_action_server_node"), bt_pool_(bt_xml_)
 {
   RCLCPP_INFO(get_logger(), "Creating");
 
@@ -82,28 +82,41 @@ void
 SampleActionServerNode::handle_accepted(
   const std::shared_ptr<GoalHandle> goal_handle)
 {
-  std::thread{
-    std::bind(&SampleActionServerNode::print_message, this, _1), goal_handle
-  }.detach();
+  print_message(goal_handle);
 }
 
 void
 SampleActionServerNode::print_message(const std::shared_ptr<GoalHandle> goal_handle)
 {
-  BehaviorTree bt(bt_xml_);
-  auto result = std::make_shared<ActionServer::Result>();
+  auto bt = bt_pool_.acquire();
+
+  // Several goals may be executing at once, and BT::StdCoutLogger is one per process
+  bt->set_console_logging(false);
 
   // Get the incoming goal from the goal handle
   auto goal = goal_handle->get_goal();
 
   // Pass the values from the goal to the Behavior Tree via the blackboard
-  bt.blackboard()->set<std::string>("message", goal->message);  // NOLINT
-  bt.blackboard()->set<int>("iterations", goal->iterations);  // NOLINT
-  bt.blackboard()->set<int>("pause_ms", goal->pause_ms);  // NOLINT
+  bt->blackboard()->set<std::string>("message", goal->message);  // NOLINT
+  bt->blackboard()->set<int>("iterations", goal->iterations);  // NOLINT
+  bt->blackboard()->set<int>("pause_ms", goal->pause_ms);  // NOLINT
+
+  BehaviorTreeExecutor::Options options;
+  options.should_halt = [goal_handle]() {return goal_handle->is_canceling();};
+
+  // The tree goes back to the pool once the executor is done with it
+  bt_executor_.submit(bt,
+    [this, goal_handle](BtStatus status) {complete_goal(goal_handle, status);},
+    options);
+}
 
-  auto should_cancel = [goal_handle]() {return goal_handle->is_canceling();};
+void
+SampleActionServerNode::complete_goal(
+  const std::shared_ptr<GoalHandle> goal_handle, BtStatus status)
+{
+  auto result = std::make_shared<ActionServer::Result>();
 
-  switch (bt.execute(should_cancel)) {
+  switch (status) {
     case ros2_behavior_tree::BtStatus::SUCCEEDED:
       RCLCPP_INFO(get_logger(), "Behavior Tree execution succeeded");
       goal_handle->succeed(result);
@@ -115,8 +128,15 @@ SampleActionServerNode::print_message(const std::shared_ptr<GoalHandle> goal_han
       break;
 
     case ros2_behavior_tree::BtStatus::HALTED:
-      RCLCPP_INFO(get_logger(), "Behavior Tree halted");
-      goal_handle->canceled(result);
+      // The executor also halts the trees it still has when it shuts down. A goal can
+      // only be canceled if the client asked for it, so abort the others
+      if (goal_handle->is_canceling()) {
+        RCLCPP_INFO(get_logger(), "Behavior Tree halted");
+        goal_handle->canceled(result);
+      } else {
+        RCLCPP_ERROR(get_logger(), "Behavior Tree halted on shutdown");
+        goal_handle->abort(result);
+      }
       break;
 
     default:
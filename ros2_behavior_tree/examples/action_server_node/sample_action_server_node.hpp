@@ -20,6 +20,8 @@
 #include "rclcpp_action/rclcpp_action.hpp"
 #include "rclcpp/rclcpp.hpp"
 #include "ros2_behavior_tree/behavior_tree.hpp"
+#include "ros2_behavior_tree/behavior_tree_executor.hpp"
+#include "ros2_behavior_tree/behavior_tree_pool.hpp"
 #include "ros2_behavior_tree_msgs/action/print_message.hpp"
 
 namespace ros2_behavior_tree
@@ -49,11 +51,18 @@ protected:
   void handle_accepted(
     const std::shared_ptr<GoalHandle> goal_handle);
 
-  // The routine to run on the separate thread
+  // Start a Behavior Tree for the goal, and report the result once the tree completes
   void print_message(const std::shared_ptr<GoalHandle> goal_handle);
+  void complete_goal(const std::shared_ptr<GoalHandle> goal_handle, BtStatus status);
 
   // The XML string that defines the Behavior Tree used to implement the print_message action
   static const char bt_xml_[];
+
+  // Ready-to-run trees, so that each goal doesn't have to parse and instantiate its own
+  BehaviorTreePool bt_pool_;
+
+  // Ticks the trees of all of the active goals on a few shared threads
+  BehaviorTreeExecutor bt_executor_;
 };
 
 }  // namespace ros2_behavior_tree
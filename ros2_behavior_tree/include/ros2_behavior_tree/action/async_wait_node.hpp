@@ -21,6 +21,7 @@
 #include <condition_variable>
 
 #include "behaviortree_cpp_v3/action_node.h"
+#include "ros2_behavior_tree/port_binding.hpp"
 
 namespace ros2_behavior_tree
 {
@@ -36,7 +37,8 @@ public:
   }
 
   AsyncWaitNode(const std::string & name, const BT::NodeConfiguration & config)
-  : BT::AsyncActionNode(name, config), read_parameters_from_ports_(true)
+  : BT::AsyncActionNode(name, config), read_parameters_from_ports_(true),
+    msec_input_(*this, "msec")
   {
   }
 
@@ -59,7 +61,7 @@ public:
   {
     // Get the wait duration from the input port
     if (read_parameters_from_ports_) {
-      if (!getInput<int>("msec", wait_duration_)) {
+      if (!msec_input_.get(wait_duration_)) {
         throw BT::RuntimeError("Missing parameter [msec] in AsyncWait node");
       }
     }
@@ -75,6 +77,7 @@ public:
 private:
   std::condition_variable cv_;
   bool read_parameters_from_ports_;
+  InputBinding<int> msec_input_;
   int wait_duration_{0};
 };
 
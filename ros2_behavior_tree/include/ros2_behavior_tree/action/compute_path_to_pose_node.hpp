@@ -15,9 +15,11 @@
 #ifndef ROS2_BEHAVIOR_TREE__ACTION__COMPUTE_PATH_TO_POSE_NODE_HPP_
 #define ROS2_BEHAVIOR_TREE__ACTION__COMPUTE_PATH_TO_POSE_NODE_HPP_
 
+#include <memory>
 #include <string>
 
 #include "ros2_behavior_tree/ros2_action_client_node.hpp"
+#include "ros2_behavior_tree/shared_message.hpp"
 #include "nav2_msgs/action/compute_path_to_pose.hpp"
 
 namespace ros2_behavior_tree
@@ -29,7 +31,10 @@ class ComputePathToPoseNode : public ros2_behavior_tree::ROS2ActionClientNode<Co
 {
 public:
   explicit ComputePathToPoseNode(const std::string & name, const BT::NodeConfiguration & config)
-  : ROS2ActionClientNode<ComputePathToPose>(name, config)
+  : ROS2ActionClientNode<ComputePathToPose>(name, config),
+    goal_input_(*this, "goal"),
+    planner_id_input_(*this, "planner_id"),
+    path_output_(*this, "path")
   {
   }
 
@@ -38,17 +43,18 @@ public:
     return augment_basic_ports({
         BT::InputPort<geometry_msgs::msg::PoseStamped>("goal", "The destination to plan to"),
         BT::InputPort<std::string>("planner_id", "The ID of the planner to use"),
-        BT::OutputPort<nav_msgs::msg::Path>("path", "The path to the destination")
+        BT::OutputPort<std::shared_ptr<const nav_msgs::msg::Path>>("path",
+          "The path to the destination")
       });
   }
 
   void read_input_ports(ComputePathToPose::Goal & goal) override
   {
-    if (!getInput<geometry_msgs::msg::PoseStamped>("goal", goal.pose)) {
+    if (!goal_input_.get(goal.pose)) {
       throw BT::RuntimeError("Missing parameter [goal] in ComputePathToPoseNode node");
     }
 
-    if (!getInput<std::string>("planner_id", goal.planner_id)) {
+    if (!planner_id_input_.get(goal.planner_id)) {
       throw BT::RuntimeError("Missing parameter [planner_id] in ComputePathToPoseNode node");
     }
   }
@@ -56,8 +62,14 @@ public:
   void write_output_ports(
     rclcpp_action::ClientGoalHandle<ComputePathToPose>::WrappedResult & result) override
   {
-    setOutput<nav_msgs::msg::Path>("path", result.result->path);
+    // Share the path with the result rather than copy it to the blackboard
+    path_output_.set(share_member(result.result, result.result->path));
   }
+
+protected:
+  InputBinding<geometry_msgs::msg::PoseStamped> goal_input_;
+  InputBinding<std::string> planner_id_input_;
+  OutputBinding<std::shared_ptr<const nav_msgs::msg::Path>> path_output_;
 };
 
 }  // namespace ros2_behavior_tree
@@ -21,6 +21,7 @@
 
 #include "behaviortree_cpp_v3/action_node.h"
 #include "rclcpp/rclcpp.hpp"
+#include "ros2_behavior_tree/executor_service.hpp"
 #include "ros2_behavior_tree/node_thread.hpp"
 
 namespace ros2_behavior_tree
@@ -40,6 +41,8 @@ public:
       BT::InputPort<std::string>("node_name", "The name of the ROS2 node to create"),
       BT::InputPort<std::string>("namespace", "The namespace in which to create the node"),
       BT::InputPort<bool>("spin", "Whether to spin this node on a separate thread"),
+      BT::InputPort<bool>("shared_executor", false,
+        "Whether to spin this node on the process-wide ExecutorService instead"),
       BT::OutputPort<std::shared_ptr<rclcpp::Node>>("node_handle",
         "The node handle of the created node")
     };
@@ -62,13 +65,18 @@ public:
       throw BT::RuntimeError("Missing parameter [spin] in CreateROS2Node");
     }
 
+    bool shared_executor = false;
+    getInput("shared_executor", shared_executor);
+
     auto node = std::make_shared<rclcpp::Node>(node_name, ns);
 
     if (!setOutput("node_handle", node)) {
       throw BT::RuntimeError("Failed to set output port value [node_handle] in CreateROS2Node");
     }
 
-    if (spin_thread) {
+    if (spin_thread && shared_executor) {
+      executor_registration_ = ExecutorService::instance().add_node(node);
+    } else if (spin_thread) {
       node_thread_ = std::make_unique<ros2_behavior_tree::NodeThread>(node);
     }
 
@@ -77,6 +85,7 @@ public:
 
 private:
   std::shared_ptr<ros2_behavior_tree::NodeThread> node_thread_;
+  std::unique_ptr<ExecutorService::Registration> executor_registration_;
 };
 
 }  // namespace ros2_behavior_tree
@@ -15,6 +15,8 @@
 #ifndef ROS2_BEHAVIOR_TREE__ACTION__FOLLOW_PATH_NODE_HPP_
 #define ROS2_BEHAVIOR_TREE__ACTION__FOLLOW_PATH_NODE_HPP_
 
+#include <cstdint>
+#include <memory>
 #include <string>
 
 #include "ros2_behavior_tree/ros2_action_client_node.hpp"
@@ -29,40 +31,69 @@ class FollowPathNode : public ros2_behavior_tree::ROS2ActionClientNode<FollowPat
 {
 public:
   explicit FollowPathNode(const std::string & name, const BT::NodeConfiguration & config)
-  : ROS2ActionClientNode<FollowPath>(name, config)
+  : ROS2ActionClientNode<FollowPath>(name, config),
+    path_input_(*this, "path"),
+    controller_id_input_(*this, "controller_id")
   {
   }
 
   static BT::PortsList providedPorts()
   {
     return augment_basic_ports({
-        BT::InputPort<nav_msgs::msg::Path>("path", "Path to follow"),
+        // Untyped, so that the path can be written either shared, as ComputePathToPose
+        // does, or as a plain nav_msgs::msg::Path (see InputBinding)
+        BT::InputPort("path", "Path to follow"),
         BT::InputPort<std::string>("controller_id", ""),
       });
   }
 
   void read_input_ports(FollowPath::Goal & goal) override
   {
-    if (!getInput<nav_msgs::msg::Path>("path", goal.path)) {
+    path_version_ = path_input_.version();
+    if (!path_input_.get(path_) || path_ == nullptr) {
       throw BT::RuntimeError("Missing parameter [path] in FollowPathNode node");
     }
 
-    if (!getInput<std::string>("controller_id", goal.controller_id)) {
+    // The path is shared with the blackboard up to here. The goal message needs its own
+    // copy, since it is copied again into the request anyway
+    goal.path = *path_;
+
+    if (!controller_id_input_.get(goal.controller_id)) {
       throw BT::RuntimeError("Missing parameter [controller_id] in FollowPathNode node");
     }
   }
 
   bool read_new_goal(FollowPath::Goal & goal) override
   {
-    nav_msgs::msg::Path path;
-    if (!getInput<nav_msgs::msg::Path>("path", path)) {
+    // If the path isn't the one we're currently working on, update the goal and return
+    // true. When the path is written through an OutputBinding (as ComputePathToPose does),
+    // its version tells whether it has been written since. Otherwise, only the pointers
+    // are compared
+    if (!path_input_.get_if_changed(path_, path_version_)) {
+      return false;
+    }
+
+    if (path_ == nullptr) {
       throw BT::RuntimeError("Missing parameter [path] in FollowPathNode node");
     }
 
-    // If it's not the same as the goal we're currently working on, update the goal
-    // and return true
-    return (path != goal_.path) ? goal_.path = path, true : false;
+    // A planner that replans periodically may write the same path again. That isn't a
+    // new goal, so don't preempt the current one for it
+    if (*path_ == goal.path) {
+      return false;
+    }
+
+    goal.path = *path_;
+    return true;
   }
+
+protected:
+  InputBinding<std::shared_ptr<const nav_msgs::msg::Path>> path_input_;
+  InputBinding<std::string> controller_id_input_;
+
+  // The path that the current goal was read from, and its version
+  std::shared_ptr<const nav_msgs::msg::Path> path_;
+  uint64_t path_version_{0};
 };
 
 }  // namespace ros2_behavior_tree
@@ -28,6 +28,8 @@
 #include "nav_msgs/msg/odometry.hpp"
 #include "nav_msgs/msg/path.hpp"
 #include "rclcpp/rclcpp.hpp"
+#include "ros2_behavior_tree/latest_value_mailbox.hpp"
+#include "ros2_behavior_tree/node_thread.hpp"
 #include "tf2_ros/transform_listener.h"
 #include "visualization_msgs/msg/marker.hpp"
 
@@ -49,7 +51,13 @@ public:
   {
     return {
       BT::InputPort<std::shared_ptr<rclcpp::Node>>("node_handle", "The ROS2 node to use"),
-      BT::InputPort<std::shared_ptr<tf2_ros::Buffer>>("tf_buffer", "The transform buffer to use")
+      BT::InputPort<std::shared_ptr<tf2_ros::Buffer>>("tf_buffer", "The transform buffer to use"),
+      BT::InputPort<bool>("subscription_thread", false,
+        "Whether to receive the path and odometry on a thread of its own"),
+      BT::InputPort<std::string>("subscription_cpus",
+        "The CPUs to run the subscription thread on, such as \"2,3\" (any if not set)"),
+      BT::InputPort<int>("subscription_priority", 0,
+        "The SCHED_FIFO priority of the subscription thread (0 for the default policy)")
     };
   }
 
@@ -91,6 +99,17 @@ protected:
   rclcpp::Publisher<visualization_msgs::msg::Marker>::SharedPtr cmd_traj_pub_;
   void path_callback(const nav_msgs::msg::Path::SharedPtr msg);
   void odometry_callback(const nav_msgs::msg::Odometry::SharedPtr msg);
+
+  // The latest messages from the subscriptions, taken by the tick
+  LatestValueMailbox<nav_msgs::msg::Path> path_mailbox_;
+  LatestValueMailbox<nav_msgs::msg::Odometry> odom_mailbox_;
+  void take_latest_messages();
+
+  // With subscription_thread set, the subscriptions are on a node of their own, in a
+  // dedicated callback group, spun by its own thread. Otherwise, they're on node_handle
+  std::shared_ptr<rclcpp::Node> subscription_node_;
+  rclcpp::callback_group::CallbackGroup::SharedPtr subscription_group_;
+  std::unique_ptr<NodeThread> subscription_thread_;
   //////////////////////////////////////
 };
 
@@ -24,6 +24,7 @@
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "rclcpp/rclcpp.hpp"
 #include "rclcpp/logger.hpp"
+#include "ros2_behavior_tree/port_binding.hpp"
 #include "tf2_geometry_msgs/tf2_geometry_msgs.h"
 #include "tf2_ros/buffer.h"
 
@@ -34,7 +35,11 @@ class TransformPoseNode : public BT::SyncActionNode
 {
 public:
   TransformPoseNode(const std::string & name, const BT::NodeConfiguration & config)
-  : BT::SyncActionNode(name, config)
+  : BT::SyncActionNode(name, config),
+    tf_buffer_input_(*this, "tf_buffer"),
+    source_frame_input_(*this, "source_frame"),
+    target_frame_input_(*this, "target_frame"),
+    pose_output_(*this, "pose")
   {
   }
 
@@ -53,17 +58,17 @@ public:
   {
     std::shared_ptr<tf2_ros::Buffer> tf_buffer;
 
-    if (!getInput<std::shared_ptr<tf2_ros::Buffer>>("tf_buffer", tf_buffer)) {
+    if (!tf_buffer_input_.get(tf_buffer)) {
       throw BT::RuntimeError("Missing parameter [tf_buffer] in TransformPose node");
     }
 
     std::string source_frame;
-    if (!getInput<std::string>("source_frame", source_frame)) {
+    if (!source_frame_input_.get(source_frame)) {
       throw BT::RuntimeError("Missing parameter [source_frame] in TransformPose node");
     }
 
     std::string target_frame;
-    if (!getInput<std::string>("target_frame", target_frame)) {
+    if (!target_frame_input_.get(target_frame)) {
       throw BT::RuntimeError("Missing parameter [target_frame] in TransformPose node");
     }
 
@@ -71,7 +76,7 @@ public:
     if (transform_pose(current_pose, tf_buffer, source_frame, target_frame)) {
       auto pose = std::make_shared<geometry_msgs::msg::PoseStamped>();
       *pose = current_pose;
-      if (!setOutput<std::shared_ptr<geometry_msgs::msg::PoseStamped>>("pose", pose)) {
+      if (!pose_output_.set(pose)) {
         throw BT::RuntimeError("Failed to set output port value [pose] for TransformPose");
       }
       return BT::NodeStatus::SUCCESS;
@@ -81,6 +86,11 @@ public:
   }
 
 protected:
+  InputBinding<std::shared_ptr<tf2_ros::Buffer>> tf_buffer_input_;
+  InputBinding<std::string> source_frame_input_;
+  InputBinding<std::string> target_frame_input_;
+  OutputBinding<std::shared_ptr<geometry_msgs::msg::PoseStamped>> pose_output_;
+
   bool transform_pose(
     geometry_msgs::msg::PoseStamped & target_pose,
     std::shared_ptr<tf2_ros::Buffer> tf_buffer,
@@ -0,0 +1,98 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__ACTION_LATENCY_HPP_
+#define ROS2_BEHAVIOR_TREE__ACTION_LATENCY_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ros2_behavior_tree/latency_histogram.hpp"
+
+namespace ros2_behavior_tree
+{
+
+// Latencies of the goals sent to an action server by ROS2ActionClientNodes. The time the
+// server takes (execution) is kept apart from the time the tree takes to notice the
+// result (result_pickup), to tell a slow server from a slow tick loop. Updated by the
+// tick threads and safe to read from any other thread
+struct ActionLatencyStatistics
+{
+  // From sending a goal to the server accepting or rejecting it
+  LatencyHistogram goal_response;
+
+  // From sending a goal to its first feedback
+  LatencyHistogram first_feedback;
+
+  // From the server accepting a goal to its result arriving
+  LatencyHistogram execution;
+
+  // From a result arriving to the node acting on it in a tick
+  LatencyHistogram result_pickup;
+
+  // From requesting that a goal be canceled to the server acknowledging it
+  LatencyHistogram cancel;
+
+  // The number of goals sent, and the number of those that were rejected
+  std::atomic<uint64_t> goals{0};
+  std::atomic<uint64_t> rejected{0};
+
+  void reset()
+  {
+    goal_response.reset();
+    first_feedback.reset();
+    execution.reset();
+    result_pickup.reset();
+    cancel.reset();
+    goals.store(0, std::memory_order_relaxed);
+    rejected.store(0, std::memory_order_relaxed);
+  }
+};
+
+//
+// @brief The ActionLatencyRegistry holds the ActionLatencyStatistics of each action name
+// used in the process, accumulated over all of the trees and nodes that use it.
+//
+class ActionLatencyRegistry
+{
+public:
+  static ActionLatencyRegistry & instance();
+
+  ActionLatencyRegistry(const ActionLatencyRegistry &) = delete;
+  ActionLatencyRegistry & operator=(const ActionLatencyRegistry &) = delete;
+
+  // The statistics for an action name, created the first time it is asked for
+  std::shared_ptr<ActionLatencyStatistics> get(const std::string & action_name);
+
+  // The statistics for all of the action names, in name order
+  std::vector<std::pair<std::string, std::shared_ptr<ActionLatencyStatistics>>> all() const;
+
+  void reset();
+
+protected:
+  ActionLatencyRegistry() = default;
+
+  mutable std::mutex mutex_;
+  std::map<std::string, std::shared_ptr<ActionLatencyStatistics>> statistics_;
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__ACTION_LATENCY_HPP_
@@ -0,0 +1,82 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__ACTION_SERVER_DISCOVERY_HPP_
+#define ROS2_BEHAVIOR_TREE__ACTION_SERVER_DISCOVERY_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief The ActionServerDiscovery keeps track, for the whole process, of the action
+// servers that are up in the ROS2 graph. The ROS2 graph is only looked at again when
+// it has changed (when the graph event is set), so checking whether a server is there
+// is normally just a lookup in a set.
+//
+// Names are resolved against the namespace of the node they are checked with. Any
+// remapping of the action name isn't taken into account, so a client that isn't found
+// here should still check with its rclcpp_action client before giving up.
+//
+class ActionServerDiscovery
+{
+public:
+  static ActionServerDiscovery & instance();
+
+  ActionServerDiscovery(const ActionServerDiscovery &) = delete;
+  ActionServerDiscovery & operator=(const ActionServerDiscovery &) = delete;
+
+  // Whether a server for the action is currently in the ROS2 graph
+  bool is_available(const rclcpp::Node::SharedPtr & node, const std::string & action_name);
+
+  // Start watching the graph and look up the specified actions ahead of time, such as
+  // those used by a tree when it is loaded. Returns the number of them that are available
+  size_t prewarm(
+    const rclcpp::Node::SharedPtr & node, const std::vector<std::string> & action_names);
+
+  // The number of times the graph has been looked at
+  uint64_t refresh_count() const;
+
+  // Resolve a relative action name against the node's namespace
+  static std::string resolve_name(
+    const rclcpp::Node::SharedPtr & node, const std::string & action_name);
+
+protected:
+  ActionServerDiscovery() = default;
+
+  // Look at the graph again if it has changed. Called with the mutex held
+  void refresh_if_changed(const rclcpp::Node::SharedPtr & node);
+
+  mutable std::mutex mutex_;
+
+  // The node whose graph event is used to detect changes to the graph. Any node will do,
+  // since they all see the same graph
+  std::weak_ptr<rclcpp::Node> watched_node_;
+  rclcpp::Event::SharedPtr graph_event_;
+
+  std::unordered_set<std::string> available_;
+  uint64_t refresh_count_{0};
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__ACTION_SERVER_DISCOVERY_HPP_
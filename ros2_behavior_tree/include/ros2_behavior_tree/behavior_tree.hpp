@@ -16,12 +16,28 @@
 #define ROS2_BEHAVIOR_TREE__BEHAVIOR_TREE_HPP_
 
 #include <memory>
+#include <ostream>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "behaviortree_cpp_v3/behavior_tree.h"
 #include "behaviortree_cpp_v3/bt_factory.h"
 #include "behaviortree_cpp_v3/xml_parsing.h"
+#include "behaviortree_cpp_v3/loggers/bt_cout_logger.h"
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "ros2_behavior_tree/action_latency.hpp"
+#include "ros2_behavior_tree/binary_transition_logger.hpp"
+#include "ros2_behavior_tree/compiled_tree.hpp"
+#include "ros2_behavior_tree/pending_cancels.hpp"
+#include "ros2_behavior_tree/tick_deadline.hpp"
+#include "ros2_behavior_tree/tick_profiler.hpp"
+#include "ros2_behavior_tree/tick_statistics.hpp"
+#include "ros2_behavior_tree/thread_options.hpp"
+#include "ros2_behavior_tree/tick_wakeup.hpp"
+#include "ros2_behavior_tree/transition_log.hpp"
 
 namespace ros2_behavior_tree
 {
@@ -36,6 +52,14 @@ public:
     const std::string & bt_xml,
     const std::vector<std::string> & plugin_library_names = {"ros2_behavior_tree_nodes"}
   );
+
+  // Create the tree from a compiled tree (see the compile_behavior_tree tool) instead of
+  // XML. The compiled tree may be shared by any number of BehaviorTrees
+  explicit BehaviorTree(
+    std::shared_ptr<const CompiledTree> compiled_tree,
+    const std::vector<std::string> & plugin_library_names = {"ros2_behavior_tree_nodes"}
+  );
+
   BehaviorTree() = delete;
   virtual ~BehaviorTree() {}
 
@@ -44,18 +68,198 @@ public:
     std::function<void()> on_loop_iteration = []() {},
     std::chrono::milliseconds tick_period = std::chrono::milliseconds(10));
 
+  // Instantiate the Behavior Tree ahead of the first call to execute(), so that the
+  // cost of creating the nodes isn't paid when the first goal arrives
+  void prepare();
+
+  // Look up the action servers used by the tree (its nodes with a literal action_name
+  // port) in the ActionServerDiscovery cache when the tree is loaded, rather than when
+  // the first goal is sent. Instantiates the tree if needed. Returns the number of those
+  // servers that are already available
+  size_t prewarm_action_servers(const rclcpp::Node::SharedPtr & node);
+
+  // Return all of the nodes of the instantiated tree to the IDLE state so that the
+  // tree can be executed again
+  void reset();
+
+  // Empty the blackboard entries written by the output ports of the tree's nodes, so that
+  // the next execution, perhaps for another caller, doesn't see the previous one's results.
+  // The entries themselves can't be removed from a BT::Blackboard, so they remain, without
+  // a value. Entries that are only read by the nodes are left alone
+  void clear_outputs();
+
+  // Stepwise execution, for ticking the tree from an external loop such as the one in
+  // BehaviorTreeExecutor. begin_execution() readies the tree for a new execution,
+  // tick_once() ticks it once, and end_execution() cleans up once the tree has completed
+  // or has been halted with halt_execution(). execute() is built from these
+  void begin_execution(std::chrono::milliseconds tick_period = std::chrono::milliseconds(10));
+  BT::NodeStatus tick_once();
+  void halt_execution();
+  void end_execution();
+
+  // When the next tick of the current execution is due, based on the tick period
+  TickWakeup::Clock::time_point next_tick_time() const {return execution_->next_tick;}
+
+  // Whether the time budget of the current execution (see set_execution_timeout) has run out
+  bool execution_timed_out() const
+  {
+    return TickDeadline::Clock::now() >= execution_->deadline;
+  }
+
+  // Whether to keep the instantiated tree between calls to execute(). If false, the
+  // tree is re-created on each call to execute()
+  void set_reuse_tree(bool reuse) {reuse_tree_ = reuse;}
+  bool reuse_tree() const {return reuse_tree_;}
+
+  // Whether to tick the tree as soon as one of its nodes reports an event (an action
+  // result, a service response, a timer, etc.) instead of waiting for the next tick period.
+  // The tick period remains the longest the tree goes without being ticked
+  void set_wake_on_event(bool wake_on_event) {wake_on_event_ = wake_on_event;}
+  bool wake_on_event() const {return wake_on_event_;}
+
+  // Have the tree ticked right away, such as after writing a new value to the blackboard
+  // or when should_halt() is about to return true. Safe to call from any thread
+  void wake() {wakeup_->notify();}
+  std::shared_ptr<TickWakeup> wakeup() {return wakeup_;}
+
+  // The time budget of each execution of the tree. The ROS2 client nodes clamp their waits
+  // to the time that remains (see TickDeadline), and the execution fails if the tree is
+  // still running once it has run out. Zero, the default, means no budget
+  void set_execution_timeout(std::chrono::milliseconds timeout) {execution_timeout_ = timeout;}
+  std::chrono::milliseconds execution_timeout() const {return execution_timeout_;}
+
+  // How long end_execution() waits for the servers to acknowledge the goals canceled while
+  // halting the tree. The nodes don't wait for the acknowledgements themselves. Zero, the
+  // default, doesn't wait at all
+  void set_cancel_timeout(std::chrono::milliseconds timeout) {cancel_timeout_ = timeout;}
+  std::chrono::milliseconds cancel_timeout() const {return cancel_timeout_;}
+  std::shared_ptr<PendingCancels> pending_cancels() {return pending_cancels_;}
+
+  // How to schedule the thread that calls execute() and so ticks the tree, such as pinning
+  // it to a CPU set and running it with SCHED_FIFO. Applied when execute() is first called
+  // on a thread. Options that need privileges the process doesn't have are skipped with a
+  // warning (see apply_thread_options)
+  void set_thread_options(const ThreadOptions & options)
+  {
+    thread_options_ = options;
+    scheduled_thread_ = std::thread::id();
+  }
+  const ThreadOptions & thread_options() const {return thread_options_;}
+
+  // Timing statistics for the tick loop, accumulated over all calls to execute()
+  const TickStatistics & tick_statistics() const {return tick_statistics_;}
+  void reset_tick_statistics() {tick_statistics_.reset();}
+
+  // The goal latencies of an action, accumulated over the action client nodes of all of the
+  // trees in the process
+  std::shared_ptr<ActionLatencyStatistics> action_latency(const std::string & action_name)
+  {
+    return ActionLatencyRegistry::instance().get(action_name);
+  }
+
+  // Periodically publish the tick statistics as a diagnostic_msgs/DiagnosticArray on the
+  // specified topic, along with the goal latencies of each action used in the process (see
+  // ActionLatencyRegistry), the service request coalescing counters (see RequestCoalescer)
+  // and the response cache statistics (see ResponseCache). The timer runs on the provided
+  // node, which must be spinning
+  void publish_tick_statistics(
+    rclcpp::Node::SharedPtr node,
+    std::chrono::milliseconds period = std::chrono::milliseconds(1000),
+    const std::string & topic = "bt_tick_statistics");
+
+  // Enable per-node profiling of the tree. The results accumulate over calls to execute()
+  // until the tree is re-instantiated
+  void set_profiling(bool profiling) {profiling_ = profiling;}
+  bool profiling() const {return profiling_;}
+
+  // Write the per-node profile as a table, or as folded stacks for flame graph tools
+  void write_profile(std::ostream & os) const;
+  void write_profile_folded(std::ostream & os) const;
+
+  // Whether to print each status change of the tree's nodes to stdout while executing
+  void set_console_logging(bool console_logging) {console_logging_ = console_logging;}
+  bool console_logging() const {return console_logging_;}
+
+  // Record each status change of the tree's nodes to a binary file, written by a
+  // background thread. Use the decode_transition_log tool to read the file. An empty
+  // filename stops the logging
+  void set_transition_log(const std::string & filename);
+  std::shared_ptr<TransitionLogWriter> transition_log() {return transition_log_;}
+
+  // The instantiated tree, or null if it hasn't been instantiated
+  BT::Tree * tree() {return tree_.get();}
+
   BT::Blackboard::Ptr blackboard() {return blackboard_;}
   BT::BehaviorTreeFactory & factory() {return factory_;}
 
 protected:
+  // Run the tick loop on the current execution until the tree completes or is halted
+  BtStatus run(std::function<bool()> should_halt, std::function<void()> on_loop_iteration);
+
   // The factory to use when dynamically constructing the Behavior Tree
   BT::BehaviorTreeFactory factory_;
 
+  // Load the node types from the BT plugins
+  void register_plugins(const std::vector<std::string> & plugin_library_names);
+
   // XML parser to parse the supplied BT XML input
   BT::XMLParser xml_parser_;
 
+  // The compiled tree to instantiate, instead of the parsed XML
+  std::shared_ptr<const CompiledTree> compiled_tree_;
+
   // The blackboard to be shared by all of the Behavior Tree's nodes
   BT::Blackboard::Ptr blackboard_;
+
+  // The instantiated tree, kept between calls to execute() when reuse is enabled
+  std::unique_ptr<BT::Tree> tree_;
+  bool reuse_tree_{true};
+
+  // The blackboard entries that the output ports of the last instantiated tree write to,
+  // each with the blackboard of its node (that of its subtree)
+  std::vector<std::pair<BT::Blackboard::Ptr, std::string>> output_entries_;
+
+  // Used by the nodes to wake up the tick loop when wake_on_event is enabled
+  std::shared_ptr<TickWakeup> wakeup_{std::make_shared<TickWakeup>()};
+  bool wake_on_event_{false};
+
+  // The goal cancels requested by the nodes that haven't been acknowledged yet
+  std::shared_ptr<PendingCancels> pending_cancels_{std::make_shared<PendingCancels>()};
+  std::chrono::milliseconds cancel_timeout_{0};
+
+  // The time budget of each execution
+  std::chrono::milliseconds execution_timeout_{0};
+
+  // The scheduling of the ticking thread, and the thread it was last applied to
+  ThreadOptions thread_options_;
+  std::thread::id scheduled_thread_;
+
+  // Timing of the tick loop and its (optional) publisher
+  TickStatistics tick_statistics_;
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr tick_statistics_pub_;
+  rclcpp::TimerBase::SharedPtr tick_statistics_timer_;
+
+  // Where status changes are logged
+  bool console_logging_{true};
+  std::shared_ptr<TransitionLogWriter> transition_log_;
+
+  // Per-node timing of the instantiated tree, when profiling is enabled
+  bool profiling_{false};
+  std::unique_ptr<TickProfiler> profiler_;
+
+  // The state of an execution in progress, between begin_execution() and end_execution()
+  struct Execution
+  {
+    std::unique_ptr<BT::StdCoutLogger> console_logger;
+    std::unique_ptr<BinaryTransitionLogger> transition_logger;
+    std::unique_ptr<TickProfiler::Instrumentation> instrumentation;
+    bool profiling{false};
+    std::chrono::milliseconds tick_period;
+    TickWakeup::Clock::time_point next_tick;
+    TickDeadline::Clock::time_point deadline;
+  };
+
+  std::unique_ptr<Execution> execution_;
 };
 
 }  // namespace ros2_behavior_tree
@@ -0,0 +1,196 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__BEHAVIOR_TREE_EXECUTOR_HPP_
+#define ROS2_BEHAVIOR_TREE__BEHAVIOR_TREE_EXECUTOR_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "ros2_behavior_tree/behavior_tree.hpp"
+#include "ros2_behavior_tree/tick_wakeup.hpp"
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief A BehaviorTreeExecutor ticks many Behavior Trees on a fixed pool of threads,
+// rather than dedicating a thread (and its sleeps) to each call to execute().
+//
+// Each submitted tree is scheduled by the time its next tick is due. Trees that are due
+// are moved to the ready queue of one of the workers, ordered by priority, and idle
+// workers steal from the queues of busy ones. A tree with wake_on_event enabled is
+// rescheduled as soon as one of its nodes notifies its TickWakeup.
+//
+// A tree must not be submitted again, or executed by other means, until its completion
+// callback has been called.
+//
+class BehaviorTreeExecutor
+{
+public:
+  using Clock = TickWakeup::Clock;
+
+  // Called on a worker thread with the final status of the tree
+  using CompletionCallback = std::function<void (BtStatus)>;
+
+  struct Options
+  {
+    // The longest the tree goes between ticks
+    std::chrono::milliseconds tick_period{10};
+
+    // When several trees are due at once, those with a higher priority are ticked first
+    int priority{0};
+
+    // Checked before each tick. The tree is halted when it returns true
+    std::function<bool()> should_halt;
+
+    // Called after each tick
+    std::function<void()> on_loop_iteration;
+  };
+
+  // Zero threads means one per hardware thread
+  explicit BehaviorTreeExecutor(unsigned int num_threads = 0);
+
+  // Halts any trees that are still executing, calling their completion callbacks with
+  // BtStatus::HALTED
+  ~BehaviorTreeExecutor();
+
+  BehaviorTreeExecutor(const BehaviorTreeExecutor &) = delete;
+  BehaviorTreeExecutor & operator=(const BehaviorTreeExecutor &) = delete;
+
+  // Start executing a tree. The executor holds on to the tree until it completes
+  void submit(
+    std::shared_ptr<BehaviorTree> bt,
+    CompletionCallback on_completion,
+    const Options & options);
+
+  void submit(std::shared_ptr<BehaviorTree> bt, CompletionCallback on_completion)
+  {
+    submit(bt, on_completion, Options());
+  }
+
+  // The number of trees currently being executed
+  size_t size() const;
+
+  unsigned int num_threads() const {return static_cast<unsigned int>(workers_.size());}
+
+protected:
+  struct Task
+  {
+    std::shared_ptr<BehaviorTree> bt;
+    CompletionCallback on_completion;
+    Options options;
+
+    // Only touched by the worker ticking the task
+    bool started{false};
+
+    // Protected by mutex_. A task is either scheduled on the timer heap, or it is in a
+    // ready queue or being ticked
+    bool scheduled{false};
+    bool done{false};
+    Clock::time_point deadline;
+    uint64_t generation{0};
+
+    // The earliest wakeup requested while the task wasn't scheduled
+    Clock::time_point woken{Clock::time_point::max()};
+  };
+
+  using TaskPtr = std::shared_ptr<Task>;
+
+  // An entry in the timer heap. Entries whose generation doesn't match their task's are
+  // stale, left behind when a task was rescheduled earlier
+  struct Timer
+  {
+    Clock::time_point deadline;
+    int priority;
+    uint64_t generation;
+    TaskPtr task;
+
+    bool operator<(const Timer & other) const
+    {
+      // std::priority_queue puts the greatest element on top, so the earliest deadline
+      // must compare as the greatest
+      if (deadline != other.deadline) {
+        return deadline > other.deadline;
+      }
+      return priority < other.priority;
+    }
+  };
+
+  // An entry in a worker's ready queue, ordered by priority and then deadline
+  struct Ready
+  {
+    int priority;
+    Clock::time_point deadline;
+    TaskPtr task;
+
+    bool operator<(const Ready & other) const
+    {
+      if (priority != other.priority) {
+        return priority < other.priority;
+      }
+      return deadline > other.deadline;
+    }
+  };
+
+  struct Worker
+  {
+    std::mutex mutex;
+    std::vector<Ready> ready;
+    std::thread thread;
+  };
+
+  void worker_loop(size_t index);
+
+  // Take the next task from a worker's own queue, or from another worker's
+  TaskPtr pop_ready(size_t index);
+  TaskPtr steal(size_t index);
+
+  // These require mutex_ to be held. schedule() returns true if the task is now the
+  // earliest on the timer heap
+  bool schedule(const TaskPtr & task, Clock::time_point deadline);
+  size_t promote_due_tasks(size_t index, Clock::time_point now);
+
+  void wake_task(const std::weak_ptr<Task> & weak_task, Clock::time_point when);
+  void step(TaskPtr task);
+
+  // Log an exception thrown by a tree, halt it and complete it as FAILED
+  void fail(const TaskPtr & task, const char * what);
+  void complete(const TaskPtr & task, BtStatus status);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  // Protects the timer heap, the scheduling state of the tasks and the set of tasks
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::priority_queue<Timer> timers_;
+  std::unordered_set<TaskPtr> tasks_;
+  bool stopping_{false};
+
+  // The number of tasks in all of the ready queues. Only increased with mutex_ held, so
+  // that a worker checking it before going to sleep can't miss new work
+  std::atomic<size_t> ready_count_{0};
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__BEHAVIOR_TREE_EXECUTOR_HPP_
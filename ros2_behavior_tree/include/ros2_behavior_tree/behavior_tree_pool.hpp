@@ -0,0 +1,110 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__BEHAVIOR_TREE_POOL_HPP_
+#define ROS2_BEHAVIOR_TREE__BEHAVIOR_TREE_POOL_HPP_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ros2_behavior_tree/behavior_tree.hpp"
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief A BehaviorTreePool keeps a set of ready-to-run BehaviorTrees created from the
+// same XML, so that a server handling many goals doesn't have to parse and instantiate
+// a new tree for each one. A tree handed out by acquire() is returned to the pool when
+// the last reference to it is released.
+//
+// A tree keeps its blackboard while it's in the pool. The entries that its nodes write
+// are emptied when it is returned (see BehaviorTree::clear_outputs), so that the results
+// of one goal can't be taken for those of the next. Any other entries, such as the inputs
+// set by the previous user, are left as they were and should be set again.
+//
+class BehaviorTreePool
+{
+public:
+  explicit BehaviorTreePool(
+    const std::string & bt_xml,
+    const std::vector<std::string> & plugin_library_names = {"ros2_behavior_tree_nodes"},
+    unsigned int initial_size = 0)
+  : bt_xml_(bt_xml), plugin_library_names_(plugin_library_names),
+    state_(std::make_shared<State>())
+  {
+    for (unsigned int i = 0; i < initial_size; i++) {
+      state_->idle.push_back(std::make_unique<BehaviorTree>(bt_xml_, plugin_library_names_));
+    }
+  }
+
+  BehaviorTreePool() = delete;
+
+  // Get a tree from the pool, creating a new one if all of the existing trees are in use.
+  // A recycled tree's blackboard still holds the entries set by its previous user, except
+  // for its nodes' outputs, which have been emptied
+  std::shared_ptr<BehaviorTree> acquire()
+  {
+    std::unique_ptr<BehaviorTree> bt;
+    {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      if (!state_->idle.empty()) {
+        bt = std::move(state_->idle.back());
+        state_->idle.pop_back();
+      }
+    }
+
+    if (bt == nullptr) {
+      bt = std::make_unique<BehaviorTree>(bt_xml_, plugin_library_names_);
+    }
+
+    // Return the tree to the pool, if the pool is still around, once the caller is done
+    std::weak_ptr<State> weak_state = state_;
+    return std::shared_ptr<BehaviorTree>(bt.release(),
+             [weak_state](BehaviorTree * tree)
+             {
+               if (auto state = weak_state.lock()) {
+                 tree->clear_outputs();
+                 std::lock_guard<std::mutex> lock(state->mutex);
+                 state->idle.emplace_back(tree);
+               } else {
+                 delete tree;
+               }
+             });
+  }
+
+  // The number of trees currently waiting in the pool
+  size_t available() const
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->idle.size();
+  }
+
+protected:
+  struct State
+  {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<BehaviorTree>> idle;
+  };
+
+  std::string bt_xml_;
+  std::vector<std::string> plugin_library_names_;
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__BEHAVIOR_TREE_POOL_HPP_
@@ -0,0 +1,70 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__BINARY_TRANSITION_LOGGER_HPP_
+#define ROS2_BEHAVIOR_TREE__BINARY_TRANSITION_LOGGER_HPP_
+
+#include <chrono>
+#include <memory>
+
+#include "behaviortree_cpp_v3/behavior_tree.h"
+#include "behaviortree_cpp_v3/loggers/abstract_logger.h"
+#include "ros2_behavior_tree/transition_log.hpp"
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief A BinaryTransitionLogger records every status change of the nodes of a tree as a
+// fixed-size record in a TransitionLogWriter. Unlike BT::StdCoutLogger, it does no
+// formatting or I/O on the tick thread. Use the decode_transition_log tool to read the
+// resulting file.
+//
+class BinaryTransitionLogger : public BT::StatusChangeLogger
+{
+public:
+  BinaryTransitionLogger(const BT::Tree & tree, std::shared_ptr<TransitionLogWriter> writer)
+  : BT::StatusChangeLogger(tree.root_node), writer_(writer)
+  {
+    for (const auto & node : tree.nodes) {
+      writer_->add_node_name(node->UID(), node->name());
+    }
+  }
+
+  void callback(
+    BT::Duration timestamp, const BT::TreeNode & node,
+    BT::NodeStatus prev_status, BT::NodeStatus status) override
+  {
+    TransitionRecord record;
+    record.timestamp_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp).count();
+    record.uid = node.UID();
+    record.prev_status = static_cast<uint8_t>(prev_status);
+    record.status = static_cast<uint8_t>(status);
+    record.extra = 0;
+    writer_->record(record);
+  }
+
+  void flush() override
+  {
+    writer_->flush();
+  }
+
+protected:
+  std::shared_ptr<TransitionLogWriter> writer_;
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__BINARY_TRANSITION_LOGGER_HPP_
@@ -0,0 +1,153 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__CLIENT_POOL_HPP_
+#define ROS2_BEHAVIOR_TREE__CLIENT_POOL_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_action/rclcpp_action.hpp"
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief The ClientPool is a process-wide set of action and service clients, keyed by the
+// ROS2 node, the action or service name and its type. All of the client nodes of the trees
+// in a process draw from it, so that a client and its DDS entities are created, and the
+// server discovered, once per node and name instead of once per BT node instance.
+//
+// The pool only holds weak references: a client lives as long as some BT node is using
+// it, and a new one is created on the next request after that.
+//
+class ClientPool
+{
+public:
+  static ClientPool & instance();
+
+  ClientPool(const ClientPool &) = delete;
+  ClientPool & operator=(const ClientPool &) = delete;
+
+  template<typename ActionT>
+  std::shared_ptr<rclcpp_action::Client<ActionT>> get_action_client(
+    const rclcpp::Node::SharedPtr & node, const std::string & action_name)
+  {
+    return get<rclcpp_action::Client<ActionT>>(node, action_name,
+             [&]() {return rclcpp_action::create_client<ActionT>(node, action_name);});
+  }
+
+  template<typename ServiceT>
+  std::shared_ptr<rclcpp::Client<ServiceT>> get_service_client(
+    const rclcpp::Node::SharedPtr & node, const std::string & service_name)
+  {
+    return get<rclcpp::Client<ServiceT>>(node, service_name,
+             [&]() {return node->create_client<ServiceT>(service_name);});
+  }
+
+  // The number of clients currently in use
+  size_t size() const;
+
+  // The number of clients the pool has created, and the number of requests it has served
+  // with an existing client
+  uint64_t created() const;
+  uint64_t reused() const;
+
+protected:
+  ClientPool() = default;
+
+  template<typename ClientT>
+  std::shared_ptr<ClientT> get(
+    const rclcpp::Node::SharedPtr & node, const std::string & name,
+    std::function<std::shared_ptr<ClientT>()> create)
+  {
+    Key key{node.get(), name, std::type_index(typeid(ClientT))};
+
+    // Create the client with the lock held, so that concurrent requests share one client
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Drop the entries of clients that are no longer used on hits too, or they would stay
+    // for as long as every request is served from the pool. Doing it once per as many
+    // requests as there are entries keeps the cost per request constant
+    if (++requests_since_pruned_ >= clients_.size()) {
+      remove_expired();
+    }
+
+    auto it = clients_.find(key);
+    if (it != clients_.end()) {
+      // Make sure the entry isn't for an earlier node that happened to have the same address
+      auto client = std::static_pointer_cast<ClientT>(it->second.client.lock());
+      if (client != nullptr && it->second.node.lock() == node) {
+        reused_++;
+        return client;
+      }
+    }
+
+    remove_expired();
+
+    auto client = create();
+    clients_[key] = Entry{node, client};
+    created_++;
+    return client;
+  }
+
+  // Drop the entries for clients that are no longer in use. Called with the mutex held,
+  // on every miss and periodically on hits
+  void remove_expired();
+
+  struct Key
+  {
+    const rclcpp::Node * node;
+    std::string name;
+    std::type_index type;
+
+    bool operator==(const Key & other) const
+    {
+      return node == other.node && type == other.type && name == other.name;
+    }
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key & key) const
+    {
+      size_t hash = std::hash<const rclcpp::Node *>()(key.node);
+      hash ^= std::hash<std::string>()(key.name) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      hash ^= key.type.hash_code() + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      return hash;
+    }
+  };
+
+  struct Entry
+  {
+    std::weak_ptr<rclcpp::Node> node;
+    std::weak_ptr<void> client;
+  };
+
+  mutable std::mutex mutex_;
+  std::unordered_map<Key, Entry, KeyHash> clients_;
+  uint64_t created_{0};
+  uint64_t reused_{0};
+  size_t requests_since_pruned_{0};
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__CLIENT_POOL_HPP_
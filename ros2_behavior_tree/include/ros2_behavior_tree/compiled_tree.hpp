@@ -0,0 +1,103 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__COMPILED_TREE_HPP_
+#define ROS2_BEHAVIOR_TREE__COMPILED_TREE_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include "behaviortree_cpp_v3/behavior_tree.h"
+#include "behaviortree_cpp_v3/bt_factory.h"
+
+namespace ros2_behavior_tree
+{
+
+//
+// A compiled tree file holds an instantiated Behavior Tree in a form that can be mapped
+// and turned back into nodes without any XML parsing: a CompiledTreeHeader, followed by
+// the nodes in depth-first order, their ports and a table of NUL-terminated strings.
+// Strings are referred to by their offset into the table. The node IDs have already been
+// checked against the factory, and each port holds its final remapping or literal value,
+// including defaults for the ports that the XML left out.
+//
+
+struct CompiledTreeHeader
+{
+  static constexpr char magic_value[8] = {'B', 'T', 'C', 'T', 'R', 'E', 'E', '\0'};
+  static constexpr uint32_t current_version = 1;
+
+  char magic[8];
+  uint32_t version;
+  uint32_t node_count;
+  uint32_t port_count;
+  uint32_t strings_size;
+};
+
+struct CompiledTreeNode
+{
+  static constexpr uint32_t no_parent = 0xffffffff;
+
+  uint32_t id;          // The registration ID of the node
+  uint32_t name;
+  uint32_t parent;      // The index of the parent node, always lower than this node's
+  uint32_t first_port;
+  uint32_t port_count;
+};
+
+struct CompiledTreePort
+{
+  uint32_t key;
+  uint32_t value;
+  uint32_t direction;  // BT::PortDirection
+};
+
+//
+// @brief A CompiledTree is a compiled tree file mapped into memory, from which any number
+// of BT::Trees can be instantiated.
+//
+class CompiledTree
+{
+public:
+  // Map a compiled tree file, throwing a BT::RuntimeError if it isn't valid
+  explicit CompiledTree(const std::string & filename);
+  ~CompiledTree();
+
+  CompiledTree(const CompiledTree &) = delete;
+  CompiledTree & operator=(const CompiledTree &) = delete;
+
+  // Create the nodes of the tree, with the node types registered in the factory
+  BT::Tree instantiate(
+    const BT::BehaviorTreeFactory & factory, const BT::Blackboard::Ptr & blackboard) const;
+
+  // Serialize an instantiated tree. SubTrees aren't supported
+  static std::string compile(const BT::Tree & tree);
+
+  uint32_t node_count() const {return header_->node_count;}
+
+protected:
+  const char * string(uint32_t offset) const {return strings_ + offset;}
+
+  void * map_{nullptr};
+  size_t size_{0};
+
+  const CompiledTreeHeader * header_{nullptr};
+  const CompiledTreeNode * nodes_{nullptr};
+  const CompiledTreePort * ports_{nullptr};
+  const char * strings_{nullptr};
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__COMPILED_TREE_HPP_
@@ -21,6 +21,7 @@
 #include "behaviortree_cpp_v3/condition_node.h"
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "rclcpp/rclcpp.hpp"
+#include "ros2_behavior_tree/port_binding.hpp"
 #include "tf2_geometry_msgs/tf2_geometry_msgs.h"
 #include "tf2_ros/buffer.h"
 
@@ -31,7 +32,11 @@ class CanTransformNode : public BT::ConditionNode
 {
 public:
   CanTransformNode(const std::string & name, const BT::NodeConfiguration & config)
-  : BT::ConditionNode(name, config)
+  : BT::ConditionNode(name, config),
+    node_handle_input_(*this, "node_handle"),
+    tf_buffer_input_(*this, "tf_buffer"),
+    source_frame_input_(*this, "source_frame"),
+    target_frame_input_(*this, "target_frame")
   {
   }
 
@@ -48,22 +53,22 @@ public:
   BT::NodeStatus tick() override
   {
     std::shared_ptr<rclcpp::Node> node;
-    if (!getInput<std::shared_ptr<rclcpp::Node>>("node_handle", node)) {
+    if (!node_handle_input_.get(node)) {
       throw BT::RuntimeError("Missing parameter [node_handle] in CanTransform node");
     }
 
     std::shared_ptr<tf2_ros::Buffer> tf_buffer;
-    if (!getInput<std::shared_ptr<tf2_ros::Buffer>>("tf_buffer", tf_buffer)) {
+    if (!tf_buffer_input_.get(tf_buffer)) {
       throw BT::RuntimeError("Missing parameter [tf_buffer] in CanTransform node");
     }
 
     std::string source_frame;
-    if (!getInput<std::string>("source_frame", source_frame)) {
+    if (!source_frame_input_.get(source_frame)) {
       throw BT::RuntimeError("Missing parameter [source_frame] in CanTransform node");
     }
 
     std::string target_frame;
-    if (!getInput<std::string>("target_frame", target_frame)) {
+    if (!target_frame_input_.get(target_frame)) {
       throw BT::RuntimeError("Missing parameter [target_frame] in CanTransform node");
     }
 
@@ -81,6 +86,12 @@ public:
       return BT::NodeStatus::FAILURE;
     }
   }
+
+protected:
+  InputBinding<std::shared_ptr<rclcpp::Node>> node_handle_input_;
+  InputBinding<std::shared_ptr<tf2_ros::Buffer>> tf_buffer_input_;
+  InputBinding<std::string> source_frame_input_;
+  InputBinding<std::string> target_frame_input_;
 };
 
 }  // namespace ros2_behavior_tree
@@ -18,6 +18,7 @@
 #include <string>
 
 #include "behaviortree_cpp_v3/control_node.h"
+#include "ros2_behavior_tree/port_binding.hpp"
 
 namespace ros2_behavior_tree
 {
@@ -51,7 +52,8 @@ public:
   }
 
   RecoveryNode(const std::string & name, const BT::NodeConfiguration & config)
-  : BT::ControlNode::ControlNode(name, config), read_parameters_from_ports_(true)
+  : BT::ControlNode::ControlNode(name, config), read_parameters_from_ports_(true),
+    num_retries_input_(*this, "num_retries")
   {
   }
 
@@ -66,7 +68,7 @@ public:
   BT::NodeStatus tick() override
   {
     if (read_parameters_from_ports_) {
-      if (!getInput("num_retries", num_retries_)) {
+      if (!num_retries_input_.get(num_retries_)) {
         throw BT::RuntimeError("Missing parameter [num_retries] in Recovery node");
       }
     }
@@ -146,6 +148,7 @@ public:
 
 private:
   bool read_parameters_from_ports_;
+  InputBinding<unsigned int> num_retries_input_;
   unsigned int current_child_idx_{0};
   unsigned int num_retries_{0};
   unsigned int retry_count_{0};
@@ -0,0 +1,104 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__COROUTINE_STACK_POOL_HPP_
+#define ROS2_BEHAVIOR_TREE__COROUTINE_STACK_POOL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief The CoroutineStackPool is a process-wide cache of the stacks used by the
+// coroutines of PooledCoroActionNodes. A node takes a stack when its coroutine starts
+// and gives it back when the coroutine completes or is halted, so the stacks are reused
+// from one goal to the next and across trees, and the process only needs as many of them
+// as there are coroutines running at the same time.
+//
+// Stacks are mapped with mmap, so only the pages a coroutine actually touches count
+// towards the resident set. A guard page below each stack turns an overflow into a
+// segmentation fault rather than silent corruption of the neighbouring memory.
+//
+class CoroutineStackPool
+{
+public:
+  struct Options
+  {
+    // The usable size of each stack, rounded up to a whole number of pages
+    size_t stack_size{256 * 1024};
+
+    // Whether to put an inaccessible page below each stack
+    bool guard_page{true};
+
+    // The most stacks kept for reuse; any more are unmapped when they are released
+    size_t max_free{64};
+  };
+
+  // A stack, from the lowest usable address up. The guard page, if any, is below base
+  struct Stack
+  {
+    void * base{nullptr};
+    size_t size{0};
+    bool guard_page{false};
+  };
+
+  static CoroutineStackPool & instance();
+
+  CoroutineStackPool(const CoroutineStackPool &) = delete;
+  CoroutineStackPool & operator=(const CoroutineStackPool &) = delete;
+
+  // Change the options for the stacks handed out from now on. The free stacks are
+  // unmapped; stacks in use are unmapped when they are released
+  void configure(const Options & options);
+  Options options() const;
+
+  // Take a stack from the pool, mapping a new one if none is free. Throws
+  // std::bad_alloc if the stack can't be mapped
+  Stack acquire();
+
+  // Return a stack to the pool
+  void release(const Stack & stack);
+
+  // The number of stacks in use and the number kept for reuse
+  size_t in_use() const;
+  size_t free() const;
+
+  // The number of stacks the pool has mapped, and the number of requests it has served
+  // with a free stack
+  uint64_t created() const;
+  uint64_t reused() const;
+
+protected:
+  CoroutineStackPool() = default;
+  ~CoroutineStackPool();
+
+  // Map a stack with the current options, and unmap one. Called with the mutex held
+  Stack map_stack() const;
+  static void unmap_stack(const Stack & stack);
+
+  mutable std::mutex mutex_;
+  Options options_;
+  std::vector<Stack> free_;
+  size_t in_use_{0};
+  uint64_t created_{0};
+  uint64_t reused_{0};
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__COROUTINE_STACK_POOL_HPP_
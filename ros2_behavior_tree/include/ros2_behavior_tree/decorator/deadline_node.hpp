@@ -0,0 +1,98 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__DECORATOR__DEADLINE_NODE_HPP_
+#define ROS2_BEHAVIOR_TREE__DECORATOR__DEADLINE_NODE_HPP_
+
+#include <chrono>
+#include <string>
+
+#include "behaviortree_cpp_v3/decorator_node.h"
+#include "ros2_behavior_tree/port_binding.hpp"
+#include "ros2_behavior_tree/tick_deadline.hpp"
+#include "ros2_behavior_tree/tick_wakeup.hpp"
+
+namespace ros2_behavior_tree
+{
+
+// Gives the child a time budget, starting when the child is first ticked. The ROS2
+// client nodes below it clamp their waits to the time that remains (see TickDeadline).
+// If the child is still running when the budget runs out, it is halted and the node
+// returns FAILURE
+class DeadlineNode : public BT::DecoratorNode
+{
+public:
+  DeadlineNode(const std::string & name, const BT::NodeConfiguration & config)
+  : BT::DecoratorNode(name, config),
+    msec_input_(*this, "msec")
+  {
+  }
+
+  static BT::PortsList providedPorts()
+  {
+    return {
+      BT::InputPort<int>("msec", "The time budget of the child, in milliseconds")
+    };
+  }
+
+private:
+  BT::NodeStatus tick() override
+  {
+    if (status() != BT::NodeStatus::RUNNING) {
+      // Start the clock since we're beginning a new iteration
+      int msec = 0;
+      if (!msec_input_.get(msec)) {
+        throw BT::RuntimeError("Missing parameter [msec] in Deadline node");
+      }
+      deadline_ = TickDeadline::Clock::now() + std::chrono::milliseconds(msec);
+    }
+
+    setStatus(BT::NodeStatus::RUNNING);
+
+    if (TickDeadline::Clock::now() >= deadline_) {
+      haltChild();
+      return BT::NodeStatus::FAILURE;
+    }
+
+    // Make the deadline available to the nodes below for the duration of the tick
+    BT::NodeStatus child_state;
+    {
+      TickDeadline::Scope deadline_scope(deadline_);
+      child_state = child_node_->executeTick();
+    }
+
+    if (child_state != BT::NodeStatus::RUNNING) {
+      return child_state;
+    }
+
+    if (TickDeadline::Clock::now() >= deadline_) {
+      haltChild();
+      return BT::NodeStatus::FAILURE;
+    }
+
+    // Ask for a tick when the budget runs out, in case the tree is waiting on events
+    if (auto wakeup = TickWakeup::current()) {
+      wakeup->notify_at(deadline_);
+    }
+
+    return BT::NodeStatus::RUNNING;
+  }
+
+  InputBinding<int> msec_input_;
+  TickDeadline::Clock::time_point deadline_;
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__DECORATOR__DEADLINE_NODE_HPP_
@@ -23,6 +23,7 @@
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "rclcpp/rclcpp.hpp"
 #include "ros2_behavior_tree/bt_conversions.hpp"
+#include "ros2_behavior_tree/port_binding.hpp"
 #include "tf2_geometry_msgs/tf2_geometry_msgs.h"
 
 namespace ros2_behavior_tree
@@ -32,7 +33,10 @@ class DistanceConstraintNode : public BT::DecoratorNode
 {
 public:
   DistanceConstraintNode(const std::string & name, const BT::NodeConfiguration & config)
-  : BT::DecoratorNode(name, config)
+  : BT::DecoratorNode(name, config),
+    threshold_input_(*this, "threshold"),
+    pose_1_input_(*this, "pose_1"),
+    pose_2_input_(*this, "pose_2")
   {
   }
 
@@ -48,17 +52,17 @@ public:
   BT::NodeStatus tick() override
   {
     double threshold;
-    if (!getInput<double>("threshold", threshold)) {
+    if (!threshold_input_.get(threshold)) {
       throw BT::RuntimeError("Missing parameter [threshold] in DistanceConstraint node");
     }
 
     std::shared_ptr<geometry_msgs::msg::PoseStamped> pose1;
-    if (!getInput<std::shared_ptr<geometry_msgs::msg::PoseStamped>>("pose_1", pose1)) {
+    if (!pose_1_input_.get(pose1)) {
       throw BT::RuntimeError("Missing parameter [pose_1] in DistanceConstraint node");
     }
 
     std::shared_ptr<geometry_msgs::msg::PoseStamped> pose2;
-    if (!getInput<std::shared_ptr<geometry_msgs::msg::PoseStamped>>("pose_2", pose2)) {
+    if (!pose_2_input_.get(pose2)) {
       throw BT::RuntimeError("Missing parameter [pose_2] in DistanceConstraint node");
     }
 
@@ -74,6 +78,11 @@ public:
 
     return child_node_->executeTick();
   }
+
+protected:
+  InputBinding<double> threshold_input_;
+  InputBinding<std::shared_ptr<geometry_msgs::msg::PoseStamped>> pose_1_input_;
+  InputBinding<std::shared_ptr<geometry_msgs::msg::PoseStamped>> pose_2_input_;
 };
 
 }  // namespace ros2_behavior_tree
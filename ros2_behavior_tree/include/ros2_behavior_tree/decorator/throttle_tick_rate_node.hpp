@@ -19,6 +19,8 @@
 #include <string>
 
 #include "behaviortree_cpp_v3/decorator_node.h"
+#include "ros2_behavior_tree/port_binding.hpp"
+#include "ros2_behavior_tree/tick_wakeup.hpp"
 
 namespace ros2_behavior_tree
 {
@@ -34,7 +36,8 @@ public:
   }
 
   ThrottleTickRateNode(const std::string & name, const BT::NodeConfiguration & config)
-  : BT::DecoratorNode(name, config), read_parameters_from_ports_(true)
+  : BT::DecoratorNode(name, config), read_parameters_from_ports_(true),
+    hz_input_(*this, "hz")
   {
   }
 
@@ -50,7 +53,7 @@ private:
   {
     if (read_parameters_from_ports_) {
       double hz = 1.0;
-      if (!getInput("hz", hz)) {
+      if (!hz_input_.get(hz)) {
         throw BT::RuntimeError("Missing parameter [hz] in ThrottleTickRate node");
       }
       period_ = 1.0 / hz;
@@ -96,10 +99,18 @@ private:
       }
     }
 
+    // Ask for a tick when the period expires, in case the tree is waiting on events
+    if (auto wakeup = TickWakeup::current()) {
+      auto remaining = std::chrono::duration<double>(period_ - seconds.count());
+      wakeup->notify_at(TickWakeup::Clock::now() +
+        std::chrono::duration_cast<TickWakeup::Clock::duration>(remaining));
+    }
+
     return BT::NodeStatus::RUNNING;
   }
 
   bool read_parameters_from_ports_;
+  InputBinding<double> hz_input_;
   std::chrono::time_point<std::chrono::high_resolution_clock> start_;
   double period_{0.0};
   bool first_time_{false};
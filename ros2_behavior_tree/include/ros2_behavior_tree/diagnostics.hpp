@@ -0,0 +1,136 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__DIAGNOSTICS_HPP_
+#define ROS2_BEHAVIOR_TREE__DIAGNOSTICS_HPP_
+
+#include <string>
+#include <vector>
+
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+#include "diagnostic_msgs/msg/key_value.hpp"
+#include "ros2_behavior_tree/action_latency.hpp"
+#include "ros2_behavior_tree/latency_histogram.hpp"
+#include "ros2_behavior_tree/request_coalescer.hpp"
+#include "ros2_behavior_tree/response_cache.hpp"
+
+namespace ros2_behavior_tree
+{
+
+// Helpers to report our statistics as diagnostic_msgs key/value pairs
+
+inline void
+add_diagnostic_value(
+  std::vector<diagnostic_msgs::msg::KeyValue> & values,
+  const std::string & key, const std::string & value)
+{
+  diagnostic_msgs::msg::KeyValue key_value;
+  key_value.key = key;
+  key_value.value = value;
+  values.push_back(key_value);
+}
+
+// Adds the count and the mean, median, 90th, 99th percentile and max latencies, in
+// microseconds, of a histogram
+inline void
+add_diagnostic_values(
+  std::vector<diagnostic_msgs::msg::KeyValue> & values,
+  const std::string & prefix, const LatencyHistogram & histogram)
+{
+  auto usec = [](std::chrono::nanoseconds ns) {
+      return std::to_string(std::chrono::duration<double, std::micro>(ns).count());
+    };
+
+  add_diagnostic_value(values, prefix + " count", std::to_string(histogram.count()));
+  add_diagnostic_value(values, prefix + " mean (us)", usec(histogram.mean()));
+  add_diagnostic_value(values, prefix + " p50 (us)", usec(histogram.percentile(0.50)));
+  add_diagnostic_value(values, prefix + " p90 (us)", usec(histogram.percentile(0.90)));
+  add_diagnostic_value(values, prefix + " p99 (us)", usec(histogram.percentile(0.99)));
+  add_diagnostic_value(values, prefix + " max (us)", usec(histogram.max()));
+}
+
+// Adds a status with the goal latencies of each action used in the process
+inline void
+add_action_latency_statuses(
+  std::vector<diagnostic_msgs::msg::DiagnosticStatus> & statuses, const std::string & prefix)
+{
+  for (const auto & entry : ActionLatencyRegistry::instance().all()) {
+    const auto & statistics = *entry.second;
+
+    diagnostic_msgs::msg::DiagnosticStatus status;
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+    status.name = prefix + ": action " + entry.first;
+
+    add_diagnostic_value(status.values, "goals",
+      std::to_string(statistics.goals.load(std::memory_order_relaxed)));
+    add_diagnostic_value(status.values, "rejected",
+      std::to_string(statistics.rejected.load(std::memory_order_relaxed)));
+    add_diagnostic_values(status.values, "goal response", statistics.goal_response);
+    add_diagnostic_values(status.values, "first feedback", statistics.first_feedback);
+    add_diagnostic_values(status.values, "execution", statistics.execution);
+    add_diagnostic_values(status.values, "result pickup", statistics.result_pickup);
+    add_diagnostic_values(status.values, "cancel", statistics.cancel);
+
+    statuses.push_back(status);
+  }
+}
+
+// Adds a status with the number of service requests shared through the RequestCoalescer
+inline void
+add_request_coalescer_status(
+  std::vector<diagnostic_msgs::msg::DiagnosticStatus> & statuses, const std::string & prefix)
+{
+  const auto & coalescer = RequestCoalescer::instance();
+  auto requests = coalescer.requests();
+  auto coalesced = coalescer.coalesced();
+
+  diagnostic_msgs::msg::DiagnosticStatus status;
+  status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+  status.name = prefix + ": coalesced service requests";
+
+  add_diagnostic_value(status.values, "requests", std::to_string(requests));
+  add_diagnostic_value(status.values, "round trips", std::to_string(coalescer.round_trips()));
+  add_diagnostic_value(status.values, "round trips saved", std::to_string(coalesced));
+  add_diagnostic_value(status.values, "hit rate",
+    std::to_string(requests == 0 ? 0.0 : static_cast<double>(coalesced) / requests));
+
+  statuses.push_back(status);
+}
+
+// Adds a status with the hits and misses of the ResponseCache
+inline void
+add_response_cache_status(
+  std::vector<diagnostic_msgs::msg::DiagnosticStatus> & statuses, const std::string & prefix)
+{
+  auto statistics = ResponseCache::instance().statistics();
+  auto lookups = statistics.hits + statistics.misses;
+
+  diagnostic_msgs::msg::DiagnosticStatus status;
+  status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+  status.name = prefix + ": service response cache";
+
+  add_diagnostic_value(status.values, "hits", std::to_string(statistics.hits));
+  add_diagnostic_value(status.values, "misses", std::to_string(statistics.misses));
+  add_diagnostic_value(status.values, "expirations", std::to_string(statistics.expirations));
+  add_diagnostic_value(status.values, "evictions", std::to_string(statistics.evictions));
+  add_diagnostic_value(status.values, "size", std::to_string(statistics.size));
+  add_diagnostic_value(status.values, "hit rate",
+    std::to_string(lookups == 0 ? 0.0 : static_cast<double>(statistics.hits) / lookups));
+
+  statuses.push_back(status);
+}
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__DIAGNOSTICS_HPP_
@@ -0,0 +1,111 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__EXECUTOR_SERVICE_HPP_
+#define ROS2_BEHAVIOR_TREE__EXECUTOR_SERVICE_HPP_
+
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief The ExecutorService spins ROS2 nodes on a process-wide MultiThreadedExecutor,
+// as an alternative to a NodeThread (and its thread) per node. Nodes are added for as
+// long as the returned Registration is held. The executor's threads are started when the
+// first node is added and stopped when the last one is removed.
+//
+// The executor is briefly stopped to add or remove a node, since that isn't safe while
+// it's spinning. Nodes are expected to come and go rarely, such as when a tree creates
+// its ROS2 nodes.
+//
+class ExecutorService
+{
+public:
+  static ExecutorService & instance();
+
+  ExecutorService(const ExecutorService &) = delete;
+  ExecutorService & operator=(const ExecutorService &) = delete;
+
+  ~ExecutorService();
+
+  // Keeps a node spinning on the executor for the lifetime of the registration. Must not
+  // be released from a callback that the executor is running. The registration keeps the
+  // service alive, so it may also be released during static destruction
+  class Registration
+  {
+  public:
+    ~Registration();
+
+    Registration(const Registration &) = delete;
+    Registration & operator=(const Registration &) = delete;
+
+  protected:
+    friend class ExecutorService;
+    Registration(
+      std::shared_ptr<ExecutorService> service,
+      rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node);
+
+    std::shared_ptr<ExecutorService> service_;
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_;
+  };
+
+  std::unique_ptr<Registration> add_node(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node);
+
+  template<typename NodeT>
+  std::unique_ptr<Registration> add_node(NodeT node)
+  {
+    return add_node(node->get_node_base_interface());
+  }
+
+  // The number of threads to spin the nodes with (0 for one per core). Takes effect the
+  // next time a node is added or removed
+  void set_thread_count(size_t thread_count);
+  size_t thread_count() const;
+
+  // The number of nodes currently being spun
+  size_t size() const;
+
+protected:
+  ExecutorService() = default;
+
+  // The instance, shared with the registrations
+  static std::shared_ptr<ExecutorService> shared_instance();
+
+  void remove_node(const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr & node);
+
+  // Start and stop spinning the nodes. Called with the mutex held
+  void start();
+  void stop();
+
+  mutable std::mutex mutex_;
+  size_t thread_count_{2};
+  std::vector<rclcpp::node_interfaces::NodeBaseInterface::SharedPtr> nodes_;
+
+  std::unique_ptr<rclcpp::executors::MultiThreadedExecutor> executor_;
+  std::unique_ptr<std::thread> thread_;
+  std::future<void> spin_done_;
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__EXECUTOR_SERVICE_HPP_
@@ -0,0 +1,136 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__LATENCY_HISTOGRAM_HPP_
+#define ROS2_BEHAVIOR_TREE__LATENCY_HISTOGRAM_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief A LatencyHistogram records durations into a fixed set of log-linear buckets
+// (eight buckets per power of two, so values are resolved to within 12.5%). Recording
+// is lock-free and allocation-free, so it can be used on the tick thread, and the
+// statistics can be read concurrently from any other thread.
+//
+class LatencyHistogram
+{
+public:
+  LatencyHistogram()
+  {
+    reset();
+  }
+
+  LatencyHistogram(const LatencyHistogram &) = delete;
+  LatencyHistogram & operator=(const LatencyHistogram &) = delete;
+
+  void record(std::chrono::nanoseconds duration)
+  {
+    uint64_t value = duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0;
+
+    buckets_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  uint64_t count() const {return count_.load(std::memory_order_relaxed);}
+
+  std::chrono::nanoseconds max() const
+  {
+    return std::chrono::nanoseconds(max_.load(std::memory_order_relaxed));
+  }
+
+  std::chrono::nanoseconds mean() const
+  {
+    uint64_t count = count_.load(std::memory_order_relaxed);
+    return std::chrono::nanoseconds(count ? sum_.load(std::memory_order_relaxed) / count : 0);
+  }
+
+  // The value below which the given fraction (0.0 - 1.0) of the recorded durations fall,
+  // reported as the upper bound of the bucket that contains it
+  std::chrono::nanoseconds percentile(double fraction) const
+  {
+    uint64_t count = count_.load(std::memory_order_relaxed);
+    if (count == 0) {
+      return std::chrono::nanoseconds(0);
+    }
+
+    uint64_t target = static_cast<uint64_t>(fraction * count);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kNumBuckets; i++) {
+      seen += buckets_[i].load(std::memory_order_relaxed);
+      if (seen > target) {
+        uint64_t upper = (i + 1 < kNumBuckets) ? bucket_lower_bound(i + 1) - 1 : UINT64_MAX;
+        return std::chrono::nanoseconds(std::min(upper, max_.load(std::memory_order_relaxed)));
+      }
+    }
+
+    return max();
+  }
+
+  void reset()
+  {
+    for (auto & bucket : buckets_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+  }
+
+protected:
+  static constexpr unsigned kSubBucketBits = 3;
+  static constexpr unsigned kSubBuckets = 1u << kSubBucketBits;
+  static constexpr size_t kNumBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  static size_t bucket_index(uint64_t value)
+  {
+    if (value < 2 * kSubBuckets) {
+      return static_cast<size_t>(value);
+    }
+
+    unsigned msb = 63 - __builtin_clzll(value);
+    unsigned shift = msb - kSubBucketBits;
+    return (shift + 1) * kSubBuckets + ((value >> shift) - kSubBuckets);
+  }
+
+  static uint64_t bucket_lower_bound(size_t index)
+  {
+    if (index < 2 * kSubBuckets) {
+      return index;
+    }
+
+    unsigned shift = static_cast<unsigned>(index / kSubBuckets) - 1;
+    return static_cast<uint64_t>(index % kSubBuckets + kSubBuckets) << shift;
+  }
+
+  std::array<std::atomic<uint64_t>, kNumBuckets> buckets_;
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> max_;
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__LATENCY_HISTOGRAM_HPP_
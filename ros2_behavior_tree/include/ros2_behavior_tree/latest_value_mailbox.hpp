@@ -0,0 +1,85 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__LATEST_VALUE_MAILBOX_HPP_
+#define ROS2_BEHAVIOR_TREE__LATEST_VALUE_MAILBOX_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief A lock-free mailbox that holds only the most recent value posted to it. A
+// producer (such as a ROS2 callback) posts values without ever waiting on the consumer,
+// and the consumer (such as the thread ticking the tree) takes the latest one when it is
+// ready for it. Values posted in between are replaced, so a flood of messages costs the
+// consumer a single take().
+//
+// The values are held by shared_ptr, so posting and taking a message doesn't copy it.
+// Any number of threads may post; take() should be called from a single thread.
+//
+template<typename T>
+class LatestValueMailbox
+{
+public:
+  using Ptr = std::shared_ptr<const T>;
+
+  LatestValueMailbox() = default;
+
+  ~LatestValueMailbox()
+  {
+    delete slot_.exchange(nullptr, std::memory_order_acquire);
+  }
+
+  LatestValueMailbox(const LatestValueMailbox &) = delete;
+  LatestValueMailbox & operator=(const LatestValueMailbox &) = delete;
+
+  // Replace the value in the mailbox, if any, with this one
+  void post(Ptr value)
+  {
+    auto previous = slot_.exchange(new Ptr(std::move(value)), std::memory_order_acq_rel);
+    if (previous != nullptr) {
+      replaced_.fetch_add(1, std::memory_order_relaxed);
+      delete previous;
+    }
+  }
+
+  // Remove the latest value from the mailbox. Returns null if nothing has been posted
+  // since the last take()
+  Ptr take()
+  {
+    auto slot = slot_.exchange(nullptr, std::memory_order_acq_rel);
+    if (slot == nullptr) {
+      return nullptr;
+    }
+
+    Ptr value = std::move(*slot);
+    delete slot;
+    return value;
+  }
+
+  // The number of values that were replaced before being taken
+  uint64_t replaced() const {return replaced_.load(std::memory_order_relaxed);}
+
+protected:
+  std::atomic<Ptr *> slot_{nullptr};
+  std::atomic<uint64_t> replaced_{0};
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__LATEST_VALUE_MAILBOX_HPP_
@@ -18,19 +18,28 @@
 #include <memory>
 
 #include "rclcpp/rclcpp.hpp"
+#include "ros2_behavior_tree/thread_options.hpp"
 
 namespace ros2_behavior_tree
 {
 
+// Spins a node on a thread of its own, optionally pinned to CPUs and run at a higher
+// priority (see ThreadOptions)
 class NodeThread
 {
 public:
-  explicit NodeThread(rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base)
+  explicit NodeThread(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base,
+    const ThreadOptions & options = ThreadOptions())
   : node_(node_base)
   {
     thread_ = std::make_unique<std::thread>(
-      [&]()
+      [&, options]()
       {
+        if (!options.is_default()) {
+          apply_thread_options(options);
+        }
+
         executor_.add_node(node_);
         executor_.spin();
         executor_.remove_node(node_);
@@ -38,8 +47,8 @@ public:
   }
 
   template<typename NodeT>
-  explicit NodeThread(NodeT node)
-  : NodeThread(node->get_node_base_interface())
+  explicit NodeThread(NodeT node, const ThreadOptions & options = ThreadOptions())
+  : NodeThread(node->get_node_base_interface(), options)
   {
   }
 
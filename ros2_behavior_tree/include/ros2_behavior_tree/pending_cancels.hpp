@@ -0,0 +1,94 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__PENDING_CANCELS_HPP_
+#define ROS2_BEHAVIOR_TREE__PENDING_CANCELS_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief PendingCancels keeps track of the goal cancellations that a tree's nodes have
+// requested but that the servers haven't acknowledged yet. Nodes request a cancel and
+// move on, rather than blocking the tick thread until it is acknowledged, and the tree
+// can wait for all of them, for a bounded time, when it is done.
+//
+// A cancel that is never acknowledged (the server went away, say) stops counting as
+// pending once its own deadline has passed.
+//
+// While a tree is being ticked, its PendingCancels is available to the nodes through
+// PendingCancels::current(), in the same way as its TickWakeup.
+//
+class PendingCancels
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  PendingCancels() = default;
+  PendingCancels(const PendingCancels &) = delete;
+  PendingCancels & operator=(const PendingCancels &) = delete;
+
+  // Record a cancel request that should be acknowledged within the timeout. Returns an
+  // id to pass to complete() once it is
+  uint64_t add(std::chrono::milliseconds timeout);
+
+  // Record that a cancel request has been acknowledged
+  void complete(uint64_t id);
+
+  // The number of cancel requests still waiting to be acknowledged
+  size_t pending();
+
+  // Wait until there are no pending cancel requests, for up to the timeout. Returns false
+  // if some are still pending
+  bool wait_all(std::chrono::milliseconds timeout);
+
+  // The PendingCancels of the tree currently being ticked on this thread (null if none)
+  static std::shared_ptr<PendingCancels> current();
+
+  // Makes a PendingCancels the current one on this thread for the lifetime of the scope
+  class Scope
+  {
+public:
+    explicit Scope(std::shared_ptr<PendingCancels> pending_cancels);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope & operator=(const Scope &) = delete;
+
+private:
+    std::shared_ptr<PendingCancels> previous_;
+  };
+
+protected:
+  // Forget about the requests whose deadline has passed. Called with the mutex held
+  void remove_expired(Clock::time_point now);
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+
+  // The deadline of each pending request, by id
+  std::map<uint64_t, Clock::time_point> deadlines_;
+  uint64_t next_id_{1};
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__PENDING_CANCELS_HPP_
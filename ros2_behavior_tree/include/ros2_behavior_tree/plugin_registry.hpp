@@ -0,0 +1,70 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__PLUGIN_REGISTRY_HPP_
+#define ROS2_BEHAVIOR_TREE__PLUGIN_REGISTRY_HPP_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "behaviortree_cpp_v3/bt_factory.h"
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief The PluginRegistry is a process-wide cache of the nodes provided by BT plugin
+// libraries. Each library is loaded and its nodes registered only once; after that,
+// a factory is populated by copying the cached manifests and builders, without going
+// through the dynamic loader again.
+//
+class PluginRegistry
+{
+public:
+  static PluginRegistry & instance();
+
+  // Register the nodes from the named plugin library (for example, "ros2_behavior_tree_nodes"
+  // for libros2_behavior_tree_nodes.so) with the factory, loading the library if this is
+  // the first time it has been requested
+  void register_nodes(BT::BehaviorTreeFactory & factory, const std::string & library_name);
+
+  // Whether the named plugin library has already been loaded
+  bool is_loaded(const std::string & library_name) const;
+
+  PluginRegistry(const PluginRegistry &) = delete;
+  PluginRegistry & operator=(const PluginRegistry &) = delete;
+
+protected:
+  PluginRegistry() = default;
+
+  // The nodes registered by a single plugin library
+  struct NodeEntry
+  {
+    BT::TreeNodeManifest manifest;
+    BT::NodeBuilder builder;
+  };
+  using PluginManifest = std::vector<NodeEntry>;
+
+  std::shared_ptr<const PluginManifest> get_manifest(const std::string & library_name);
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<const PluginManifest>> manifests_;
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__PLUGIN_REGISTRY_HPP_
@@ -0,0 +1,98 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__POOLED_CORO_ACTION_NODE_HPP_
+#define ROS2_BEHAVIOR_TREE__POOLED_CORO_ACTION_NODE_HPP_
+
+#include <exception>
+#include <string>
+
+#include "behaviortree_cpp_v3/action_node.h"
+#include "boost/context/detail/fcontext.hpp"
+#include "ros2_behavior_tree/coroutine_stack_pool.hpp"
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief A drop-in replacement for BT::CoroActionNode whose coroutine runs on a stack from
+// the CoroutineStackPool. BT::CoroActionNode allocates a new stack each time its coroutine
+// starts, which adds up for trees with many client nodes that are re-instantiated per goal.
+// Here the stack is taken from the pool when the coroutine starts and returned to it when
+// the coroutine completes or is halted. Like BT::CoroActionNode, it switches contexts with
+// Boost.Context, which, unlike swapcontext, doesn't make a system call to save and restore
+// the signal mask on every switch.
+//
+// As with BT::CoroActionNode, tick() runs in the coroutine and setStatusRunningAndYield()
+// returns control to the tree until the next tick. Halting the node unwinds the coroutine
+// from the point where it yielded, running the destructors of its locals, by throwing an
+// exception out of setStatusRunningAndYield(); tick() must let it through rather than
+// catching it with catch (...).
+//
+// The coroutine runs the derived class's tick(), so it must be unwound before the derived
+// class is destroyed. BT::Tree halts its nodes before destroying them; a derived class
+// that may be destroyed while running otherwise should call halt() in its own destructor.
+//
+class PooledCoroActionNode : public BT::ActionNodeBase
+{
+public:
+  PooledCoroActionNode(const std::string & name, const BT::NodeConfiguration & config);
+  ~PooledCoroActionNode() override;
+
+  PooledCoroActionNode(const PooledCoroActionNode &) = delete;
+  PooledCoroActionNode & operator=(const PooledCoroActionNode &) = delete;
+
+  // Set the status to RUNNING and return to the tree. tick() continues from here when the
+  // node is next ticked
+  void setStatusRunningAndYield();
+
+  // Start the coroutine, or resume it where it yielded
+  BT::NodeStatus executeTick() override;
+
+  // Unwind the coroutine, if it is running, and give its stack back to the pool
+  void halt() override;
+
+private:
+  // Thrown out of setStatusRunningAndYield() to unwind a halted coroutine. Deliberately
+  // not a std::exception, so that handlers for those don't catch it
+  struct Unwind {};
+
+  // Where the coroutine starts
+  static void run_coroutine(boost::context::detail::transfer_t transfer);
+
+  // Switch from the tree to the coroutine, returning once it yields or completes
+  void resume();
+
+  // Give the stack back to the pool once the coroutine has completed
+  void finish();
+
+  // Where to continue on the tree's side when the coroutine yields, and on the coroutine's
+  // side when it is resumed
+  boost::context::detail::fcontext_t caller_context_{nullptr};
+  boost::context::detail::fcontext_t coroutine_context_{nullptr};
+  CoroutineStackPool::Stack stack_;
+
+  // Whether the coroutine has been started and hasn't completed yet
+  bool active_{false};
+
+  // Set when the coroutine returns from tick() or is unwound
+  bool completed_{false};
+  bool unwinding_{false};
+  BT::NodeStatus result_{BT::NodeStatus::IDLE};
+  std::exception_ptr exception_;
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__POOLED_CORO_ACTION_NODE_HPP_
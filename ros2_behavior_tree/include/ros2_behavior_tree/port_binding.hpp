@@ -0,0 +1,281 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__PORT_BINDING_HPP_
+#define ROS2_BEHAVIOR_TREE__PORT_BINDING_HPP_
+
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+
+#include "behaviortree_cpp_v3/behavior_tree.h"
+
+namespace ros2_behavior_tree
+{
+
+//
+// Port bindings resolve a node's port once, when the node is constructed, instead of on
+// every call to getInput() or setOutput(). A bound port remembers the blackboard key it
+// is remapped to and, after the first access, the blackboard entry itself, so reading or
+// writing it doesn't involve any string lookups. Entries are never removed from a
+// BT::Blackboard, so the cached entry stays valid for the life of the blackboard. Ports
+// with a literal value in the XML are converted to their type once, up front.
+//
+// Each write through an OutputBinding also increments a version number kept in a companion
+// blackboard entry, so that a reader can tell whether a value has changed without copying
+// or comparing it. Values written any other way (Blackboard::set, setOutput) don't update
+// the version, so a key should be written either always or never through OutputBindings.
+//
+// An InputBinding of a shared message, std::shared_ptr<const M>, also reads an entry that
+// holds a plain M, by copying it, so that a port can move to sharing its message without
+// breaking the nodes and trees that write the message itself.
+//
+// Bindings are meant to be used from the thread ticking the tree. Like the BT.CPP API,
+// they don't protect a value against concurrent writes from other threads.
+//
+
+// Resolves the remapping of a port, as BT::TreeNode::getInput/setOutput do
+class PortBinding
+{
+public:
+  PortBinding() = default;
+
+  PortBinding(
+    const BT::TreeNode & node, const std::string & port_name,
+    const BT::PortsRemapping & remappings)
+  : port_name_(port_name), blackboard_(node.config().blackboard)
+  {
+    auto it = remappings.find(port_name);
+    if (it == remappings.end()) {
+      return;
+    }
+
+    const std::string & remapping = it->second;
+    if (remapping == "=") {
+      key_ = port_name;
+      bound_ = true;
+    } else if (BT::TreeNode::isBlackboardPointer(remapping)) {
+      auto key = BT::TreeNode::stripBlackboardPointer(remapping);
+      key_.assign(key.data(), key.size());
+      bound_ = true;
+    } else {
+      literal_ = remapping;
+      is_literal_ = true;
+    }
+
+    if (bound_) {
+      version_key_ = version_key(key_);
+    }
+  }
+
+  const std::string & port_name() const {return port_name_;}
+
+  // Whether the port is remapped to a blackboard entry
+  bool is_bound() const {return bound_ && blackboard_ != nullptr;}
+
+  // Whether the port has a literal value in the XML
+  bool is_literal() const {return is_literal_;}
+
+  // The number of times the port's blackboard entry has been written through an
+  // OutputBinding. Zero if it never has, in which case there's no telling from the
+  // version whether the value has changed
+  uint64_t version() const
+  {
+    if (!is_bound()) {
+      return 0;
+    }
+
+    const BT::Any * any = version_entry();
+    return (any == nullptr || any->empty()) ? 0 : any->cast<uint64_t>();
+  }
+
+  // The blackboard key of the version of an entry
+  static std::string version_key(const std::string & key) {return key + "@version";}
+
+protected:
+  // The blackboard entry for the port, looked up the first time it exists
+  BT::Any * entry() const
+  {
+    if (entry_ == nullptr) {
+      entry_ = blackboard_->getAny(key_);
+    }
+    return entry_;
+  }
+
+  BT::Any * version_entry() const
+  {
+    if (version_entry_ == nullptr) {
+      version_entry_ = blackboard_->getAny(version_key_);
+    }
+    return version_entry_;
+  }
+
+  std::string port_name_;
+  BT::Blackboard::Ptr blackboard_;
+
+  bool bound_{false};
+  std::string key_;
+  std::string version_key_;
+  mutable BT::Any * entry_{nullptr};
+  mutable BT::Any * version_entry_{nullptr};
+
+  bool is_literal_{false};
+  std::string literal_;
+};
+
+template<typename T>
+class InputBinding : public PortBinding
+{
+public:
+  InputBinding() = default;
+
+  InputBinding(const BT::TreeNode & node, const std::string & port_name)
+  : PortBinding(node, port_name, node.config().input_ports)
+  {
+    // A literal value can't change, so convert it once, when the tree is created. This
+    // also reports a bad value when the tree is loaded instead of when the node first runs
+    if (is_literal_) {
+      try {
+        literal_value_ = BT::convertFromString<T>(literal_);
+      } catch (const std::exception & ex) {
+        throw BT::RuntimeError("Invalid value \"" + literal_ + "\" for port [" + port_name +
+                "] of node " + node.name() + ": " + ex.what());
+      }
+    }
+  }
+
+  // Read the value of the port. Returns false if the port isn't set or its value can't
+  // be converted to T
+  bool get(T & value) const
+  {
+    if (is_literal_) {
+      value = literal_value_;
+      return true;
+    }
+
+    try {
+      if (!is_bound()) {
+        return false;
+      }
+
+      const BT::Any * any = entry();
+      if (any == nullptr || any->empty()) {
+        return false;
+      }
+
+      // Like getInput(), accept a string entry, such as one written by SetBlackboard, and
+      // convert it to T
+      if (!std::is_same<T, std::string>::value && any->type() == typeid(std::string)) {
+        value = BT::convertFromString<T>(any->cast<std::string>());
+      } else {
+        read(*any, value);
+      }
+      return true;
+    } catch (const std::exception &) {
+      return false;
+    }
+  }
+
+  // Read the value of the port only if it has changed since the specified version, and
+  // update the version. Returns true if the value was read. When the entry isn't
+  // versioned, the current value is read and compared with the one passed in instead
+  bool get_if_changed(T & value, uint64_t & version) const
+  {
+    uint64_t current_version = this->version();
+    if (current_version != 0) {
+      if (current_version == version || !get(value)) {
+        return false;
+      }
+
+      version = current_version;
+      return true;
+    }
+
+    T current;
+    if (!get(current) || current == value) {
+      return false;
+    }
+
+    value = current;
+    version = 0;
+    return true;
+  }
+
+protected:
+  template<typename M>
+  static void read(const BT::Any & any, std::shared_ptr<const M> & value)
+  {
+    if (any.type() == typeid(M)) {
+      value = std::make_shared<const M>(any.cast<M>());
+    } else {
+      value = any.cast<std::shared_ptr<const M>>();
+    }
+  }
+
+  template<typename U>
+  static void read(const BT::Any & any, U & value)
+  {
+    value = any.cast<U>();
+  }
+
+  // The converted value of a literal port
+  T literal_value_{};
+};
+
+template<typename T>
+class OutputBinding : public PortBinding
+{
+public:
+  OutputBinding() = default;
+
+  OutputBinding(const BT::TreeNode & node, const std::string & port_name)
+  : PortBinding(node, port_name, node.config().output_ports)
+  {
+  }
+
+  // Write the value of the port. Returns false if the port isn't remapped to a
+  // blackboard entry
+  bool set(const T & value)
+  {
+    if (!is_bound()) {
+      return false;
+    }
+
+    // The first write goes through the blackboard, which creates the entry and checks
+    // its type. Later writes of the same type can go straight to the entry
+    if (entry_ == nullptr) {
+      blackboard_->set<T>(key_, value);
+      entry_ = blackboard_->getAny(key_);
+    } else {
+      *entry_ = BT::Any(value);
+    }
+
+    // Let readers know that the value has changed
+    BT::Any * version = version_entry();
+    if (version == nullptr) {
+      blackboard_->set<uint64_t>(version_key_, 1);
+      version_entry_ = blackboard_->getAny(version_key_);
+    } else {
+      *version = BT::Any(version->cast<uint64_t>() + 1);
+    }
+    return true;
+  }
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__PORT_BINDING_HPP_
@@ -0,0 +1,239 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__REQUEST_COALESCER_HPP_
+#define ROS2_BEHAVIOR_TREE__REQUEST_COALESCER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief The RequestCoalescer lets the service client nodes of all of the trees in a
+// process share calls. A request that is identical (by the message's operator==) to one
+// that has been sent to the same service, but not answered yet, doesn't go to the server
+// again: it shares that call's response instead.
+//
+// A request can also be held for a short batch window before it is sent, so that
+// identical requests from a burst, such as several trees clearing the same costmap in
+// the same tick, are merged into one call even if they don't overlap in time otherwise.
+// The held requests are sent by a background thread, started the first time one is
+// needed.
+//
+class RequestCoalescer
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  template<typename ServiceT>
+  using SharedFuture = std::shared_future<typename ServiceT::Response::SharedPtr>;
+
+  // The (possibly shared) call made for a request
+  template<typename ServiceT>
+  struct Handle
+  {
+    SharedFuture<ServiceT> future;
+    std::shared_ptr<void> call;
+  };
+
+  static RequestCoalescer & instance();
+
+  RequestCoalescer(const RequestCoalescer &) = delete;
+  RequestCoalescer & operator=(const RequestCoalescer &) = delete;
+
+  // Send a request to the client's service, or join an identical request that is already
+  // waiting for its response. A new request is sent after the batch window. on_response,
+  // if provided, is called on the ROS2 node's thread once the response has arrived
+  template<typename ServiceT>
+  Handle<ServiceT> send_request(
+    const std::shared_ptr<rclcpp::Client<ServiceT>> & client,
+    const std::shared_ptr<typename ServiceT::Request> & request,
+    std::chrono::milliseconds batch_window = std::chrono::milliseconds(0),
+    std::function<void()> on_response = nullptr)
+  {
+    Key key{client->get_service_name(), std::type_index(typeid(ServiceT))};
+    std::shared_ptr<TypedCall<ServiceT>> call;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      requests_++;
+
+      auto & calls = calls_[key];
+      for (const auto & existing : calls) {
+        auto typed = std::static_pointer_cast<TypedCall<ServiceT>>(existing);
+        if (*typed->request == *request) {
+          coalesced_++;
+          typed->waiters++;
+          if (on_response) {
+            typed->callbacks.push_back(std::move(on_response));
+          }
+          return Handle<ServiceT>{typed->future, typed};
+        }
+      }
+
+      // The caller is free to change its request once we return, so send a copy
+      call = std::make_shared<TypedCall<ServiceT>>();
+      call->key = key;
+      call->request = std::make_shared<typename ServiceT::Request>(*request);
+      call->future = call->promise.get_future().share();
+      if (on_response) {
+        call->callbacks.push_back(std::move(on_response));
+      }
+
+      // The call keeps its send function, so the function can only hold the call weakly.
+      // It holds the client weakly too, so that a call still in its batch window doesn't
+      // keep the client alive. Once sent, the call is held by the response callback,
+      // through the client's pending request, until the response arrives
+      std::weak_ptr<rclcpp::Client<ServiceT>> weak_client = client;
+      std::weak_ptr<TypedCall<ServiceT>> weak_call = call;
+      call->send = [this, weak_client, weak_call]() {
+          auto client = weak_client.lock();
+          auto call = weak_call.lock();
+          if (client == nullptr || call == nullptr) {
+            return;
+          }
+
+          client->async_send_request(call->request,
+            [this, call](typename rclcpp::Client<ServiceT>::SharedFuture future) {
+              auto callbacks = complete(call);
+              try {
+                call->promise.set_value(future.get());
+              } catch (...) {
+                call->promise.set_exception(std::current_exception());
+              }
+              for (auto & callback : callbacks) {
+                callback();
+              }
+            });
+        };
+
+      calls.push_back(call);
+      round_trips_++;
+
+      if (batch_window.count() > 0) {
+        schedule(call, Clock::now() + batch_window);
+        return Handle<ServiceT>{call->future, call};
+      }
+    }
+
+    call->send();
+    return Handle<ServiceT>{call->future, call};
+  }
+
+  // Give up on a call, such as when the caller has stopped waiting for its response. Each
+  // handle should be abandoned at most once. When every caller sharing the call has given
+  // up on it, it is no longer shared, so the next identical request is sent to the server
+  // again, and it isn't sent at all if it is still in its batch window
+  void abandon(const std::shared_ptr<void> & call);
+
+  // The number of requests made, the number actually sent to a server, and the number
+  // that shared a call with an earlier request
+  uint64_t requests() const;
+  uint64_t round_trips() const;
+  uint64_t coalesced() const;
+
+protected:
+  RequestCoalescer() = default;
+  ~RequestCoalescer();
+
+  struct Key
+  {
+    std::string service;
+    std::type_index type;
+
+    bool operator==(const Key & other) const
+    {
+      return type == other.type && service == other.service;
+    }
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key & key) const
+    {
+      size_t hash = std::hash<std::string>()(key.service);
+      hash ^= key.type.hash_code() + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      return hash;
+    }
+  };
+
+  struct Call
+  {
+    virtual ~Call() = default;
+
+    Key key{std::string(), std::type_index(typeid(void))};
+    std::function<void()> send;
+
+    // The number of callers sharing the call that haven't abandoned it
+    size_t waiters{1};
+
+    // Called once the response has arrived
+    std::vector<std::function<void()>> callbacks;
+  };
+
+  template<typename ServiceT>
+  struct TypedCall : public Call
+  {
+    std::shared_ptr<typename ServiceT::Request> request;
+    std::promise<typename ServiceT::Response::SharedPtr> promise;
+    SharedFuture<ServiceT> future;
+  };
+
+  // Stop sharing a call. Called with the mutex held
+  void remove(const std::shared_ptr<Call> & call);
+
+  // Stop sharing a call whose response has arrived, and return its callbacks
+  std::vector<std::function<void()>> complete(const std::shared_ptr<Call> & call);
+
+  // Have the background thread send a call at the specified time. Called with the mutex held
+  void schedule(const std::shared_ptr<Call> & call, Clock::time_point when);
+
+  // The background thread that sends the calls once their batch window has passed
+  void send_batched();
+
+  mutable std::mutex mutex_;
+
+  // The calls that haven't been answered yet, by service
+  std::unordered_map<Key, std::vector<std::shared_ptr<Call>>, KeyHash> calls_;
+
+  // The calls waiting for their batch window to pass, by send time
+  std::multimap<Clock::time_point, std::shared_ptr<Call>> batched_;
+  std::condition_variable batched_cv_;
+  std::thread sender_;
+  bool stopping_{false};
+
+  uint64_t requests_{0};
+  uint64_t round_trips_{0};
+  uint64_t coalesced_{0};
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__REQUEST_COALESCER_HPP_
@@ -0,0 +1,154 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__RESPONSE_CACHE_HPP_
+#define ROS2_BEHAVIOR_TREE__RESPONSE_CACHE_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rmw/rmw.h"
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief The ResponseCache is a process-wide cache of the responses of services that are
+// pure queries, shared by the service client nodes of all of the trees in a process. A
+// response is kept for the time to live given when it is stored, and looked up by the
+// fully resolved service name and the serialized request, so any identical request to the
+// same service gets it. The cache holds a bounded number of responses, evicting the least
+// recently used.
+//
+// Cached responses are shared by everyone who gets them, so they are stored and handed out
+// as const. A caller that needs to modify one works on a copy.
+//
+class ResponseCache
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Statistics
+  {
+    uint64_t hits{0};
+    uint64_t misses{0};
+
+    // The misses because the response had expired, and the responses evicted to make room
+    uint64_t expirations{0};
+    uint64_t evictions{0};
+
+    size_t size{0};
+  };
+
+  static ResponseCache & instance();
+
+  ResponseCache(const ResponseCache &) = delete;
+  ResponseCache & operator=(const ResponseCache &) = delete;
+
+  // The key of a request to a service, given its fully resolved name (such as from
+  // rclcpp::ClientBase::get_service_name())
+  template<typename ServiceT>
+  static std::string key(const std::string & service, const typename ServiceT::Request & request)
+  {
+    using RequestT = typename ServiceT::Request;
+
+    std::string key = service;
+    key += '\0';
+    key += typeid(ServiceT).name();
+    key += '\0';
+
+    auto allocator = rcutils_get_default_allocator();
+    rmw_serialized_message_t serialized = rmw_get_zero_initialized_serialized_message();
+    if (rmw_serialized_message_init(&serialized, 0, &allocator) != RMW_RET_OK) {
+      throw std::runtime_error("ResponseCache: failed to initialize serialized message");
+    }
+
+    auto type_support = rosidl_typesupport_cpp::get_message_type_support_handle<RequestT>();
+    if (rmw_serialize(&request, type_support, &serialized) != RMW_RET_OK) {
+      rmw_serialized_message_fini(&serialized);
+      throw std::runtime_error("ResponseCache: failed to serialize request");
+    }
+
+    key.append(reinterpret_cast<const char *>(serialized.buffer), serialized.buffer_length);
+    rmw_serialized_message_fini(&serialized);
+    return key;
+  }
+
+  // Look up the response for a key. Returns null if there isn't one or it has expired
+  template<typename ServiceT>
+  std::shared_ptr<const typename ServiceT::Response> get(const std::string & key)
+  {
+    return std::static_pointer_cast<const typename ServiceT::Response>(lookup(key));
+  }
+
+  // Store the response for a key, for the time to live. The caller must not modify the
+  // response afterwards
+  template<typename ServiceT>
+  void put(
+    const std::string & key, std::shared_ptr<const typename ServiceT::Response> response,
+    std::chrono::milliseconds ttl)
+  {
+    store(key, std::move(response), ttl);
+  }
+
+  // The most responses to keep. Defaults to 1024
+  void set_capacity(size_t capacity);
+  size_t capacity() const;
+
+  // Remove all of the responses
+  void clear();
+
+  Statistics statistics() const;
+
+protected:
+  ResponseCache() = default;
+
+  std::shared_ptr<const void> lookup(const std::string & key);
+  void store(const std::string & key, std::shared_ptr<const void> response,
+    std::chrono::milliseconds ttl);
+
+  // Evict the least recently used responses until there are no more than the capacity.
+  // Called with the mutex held
+  void trim();
+
+  struct Entry
+  {
+    std::string key;
+    std::shared_ptr<const void> response;
+    Clock::time_point expires;
+  };
+
+  mutable std::mutex mutex_;
+
+  // The responses, most recently used first, and their index
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  size_t capacity_{1024};
+
+  Statistics statistics_;
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__RESPONSE_CACHE_HPP_
@@ -15,23 +15,42 @@
 #ifndef ROS2_BEHAVIOR_TREE__ROS2_ACTION_CLIENT_NODE_HPP_
 #define ROS2_BEHAVIOR_TREE__ROS2_ACTION_CLIENT_NODE_HPP_
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 
 #include "behaviortree_cpp_v3/action_node.h"
 #include "rclcpp/rclcpp.hpp"
 #include "rclcpp_action/rclcpp_action.hpp"
+#include "ros2_behavior_tree/action_latency.hpp"
+#include "ros2_behavior_tree/action_server_discovery.hpp"
+#include "ros2_behavior_tree/client_pool.hpp"
+#include "ros2_behavior_tree/latest_value_mailbox.hpp"
 #include "ros2_behavior_tree/bt_conversions.hpp"
+#include "ros2_behavior_tree/pending_cancels.hpp"
+#include "ros2_behavior_tree/pooled_coro_action_node.hpp"
+#include "ros2_behavior_tree/port_binding.hpp"
+#include "ros2_behavior_tree/tick_deadline.hpp"
+#include "ros2_behavior_tree/tick_wakeup.hpp"
 
 namespace ros2_behavior_tree
 {
 
 template<class ActionT>
-class ROS2ActionClientNode : public BT::CoroActionNode
+class ROS2ActionClientNode : public PooledCoroActionNode
 {
 public:
   ROS2ActionClientNode(const std::string & name, const BT::NodeConfiguration & config)
-  : BT::CoroActionNode(name, config)
+  : PooledCoroActionNode(name, config),
+    action_name_input_(*this, "action_name"),
+    server_timeout_input_(*this, "server_timeout"),
+    ros2_node_input_(*this, "ros2_node")
   {
     // Initialize the input and output messages
     goal_ = typename ActionT::Goal();
@@ -40,6 +59,11 @@ public:
 
   ROS2ActionClientNode() = delete;
 
+  ~ROS2ActionClientNode()
+  {
+    halt();
+  }
+
   // Define the ports required by the ROS2ActionClient node
   static BT::PortsList augment_basic_ports(BT::PortsList additional_ports)
   {
@@ -64,87 +88,194 @@ public:
   }
 
   // A derived class the defines input and/or output ports can override these methods
-  // to get/set the ports
+  // to get/set the ports. They are all called from the thread ticking the tree; feedback
+  // is passed on once per tick, with only the latest message if several have arrived
   virtual void read_input_ports(typename ActionT::Goal & goal) {}
   virtual bool read_new_goal(typename ActionT::Goal & goal) {return false;}
   virtual void write_feedback_ports(const std::shared_ptr<const typename ActionT::Feedback>) {}
   virtual void write_output_ports(
     typename rclcpp_action::ClientGoalHandle<ActionT>::WrappedResult & result) {}
 
-  void feedback_callback(
-    typename rclcpp_action::ClientGoalHandle<ActionT>::SharedPtr goal_handle,
-    const std::shared_ptr<const typename ActionT::Feedback> feedback)
-  {
-    write_feedback_ports(feedback);
-  }
-
   // The main override required by a BT action
   BT::NodeStatus tick() override
   {
-    if (!getInput("action_name", action_name_)) {
+    if (!action_name_input_.get(action_name_)) {
       throw BT::RuntimeError("Missing parameter [action_name] in ROS2ActionClientNode");
     }
 
-    if (!getInput<std::chrono::milliseconds>("server_timeout", server_timeout_)) {
+    if (!server_timeout_input_.get(server_timeout_)) {
       throw BT::RuntimeError("Missing parameter [server_timeout] in ROS2ActionClientNode");
     }
 
-    if (!getInput<std::shared_ptr<rclcpp::Node>>("ros2_node", ros2_node_)) {
+    if (!ros2_node_input_.get(ros2_node_)) {
       throw BT::RuntimeError("Missing parameter [ros2_node] in ROS2ActionClientNode");
     }
 
     read_input_ports(goal_);
 
-    if (action_client_ == nullptr) {
-      action_client_ = rclcpp_action::create_client<ActionT>(ros2_node_, action_name_);
+    // A tree that is reused across runs may be given a different ROS2 node or action name
+    // on a later run. Clients are shared with the other nodes using the same action
+    if (action_client_ == nullptr || ros2_node_ != client_ros2_node_ ||
+      action_name_ != client_action_name_)
+    {
+      action_client_ = ClientPool::instance().get_action_client<ActionT>(
+        ros2_node_, action_name_);
+      client_ros2_node_ = ros2_node_;
+      client_action_name_ = action_name_;
+      client_ready_ = false;
+      statistics_ = ActionLatencyRegistry::instance().get(action_name_);
+    }
+
+    // The goal response and result callbacks let the coroutine know when to continue, and
+    // wake up the tree's tick loop, which also enables result awareness. In the meantime,
+    // the coroutine yields right away so that the rest of the tree keeps running
+    wakeup_ = TickWakeup::current();
+    pending_cancels_ = PendingCancels::current();
+
+    // Nothing has been sent yet for this run, so there's no goal for halt() to cancel
+    goal_handle_.reset();
+    events_.reset();
+
+    // The waits below are also bounded by the deadline of the part of the tree we're in, if
+    // there is one (see TickDeadline)
+    if (TickDeadline::expired()) {
+      RCLCPP_ERROR(ros2_node_->get_logger(),
+        "Deadline expired before sending a goal to \"%s\"", action_name_.c_str());
+      return BT::NodeStatus::FAILURE;
     }
 
     // Make sure the action server is available there before continuing
-    if (!action_client_->wait_for_action_server(std::chrono::milliseconds(server_timeout_))) {
+    if (!yield_until_server_ready()) {
       RCLCPP_ERROR(ros2_node_->get_logger(),
         "Timed out waiting for action server \"%s\" to become available", action_name_.c_str());
       return BT::NodeStatus::FAILURE;
     }
 
-    // Enable result awareness by providing an empty lambda function
+new_goal_received:
+    // Each goal gets its own events, so that late callbacks for a canceled goal, including
+    // its feedback, don't affect the next one. The latencies seen by the callbacks are
+    // recorded right away, on the ROS2 node's thread
+    auto events = std::make_shared<GoalEvents>();
+    goal_handle_.reset();
+    events_ = events;
     auto send_goal_options = typename rclcpp_action::Client<ActionT>::SendGoalOptions();
-    send_goal_options.result_callback = [](auto) {};
-    send_goal_options.feedback_callback = std::bind(
-      &ROS2ActionClientNode<ActionT>::feedback_callback, this,
-      std::placeholders::_1, std::placeholders::_2);
+    send_goal_options.goal_response_callback =
+      [events, statistics = statistics_, wakeup = wakeup_](auto future_goal_handle) {
+        // If the node was halted while waiting for this response, cancel the goal now.
+        // Otherwise, leave the goal handle for halt() until the node picks it up
+        auto goal_handle = future_goal_handle.get();
+        GoalCanceller cancel;
+        {
+          std::lock_guard<std::mutex> lock(events->mutex);
+          cancel = std::move(events->cancel_on_response);
+          if (!cancel) {
+            events->goal_handle = goal_handle;
+          }
+        }
+        if (cancel) {
+          cancel(goal_handle);
+        }
 
-new_goal_received:
+        events->goal_response_time = now_ns();
+        statistics->goal_response.record(
+          std::chrono::nanoseconds(events->goal_response_time - events->sent_time));
+        events->goal_response_received = true;
+        if (wakeup) {
+          wakeup->notify();
+        }
+      };
+    send_goal_options.result_callback =
+      [events, statistics = statistics_, wakeup = wakeup_](auto) {
+        events->release_goal_handle();
+        events->result_time = now_ns();
+        statistics->execution.record(
+          std::chrono::nanoseconds(events->result_time - events->goal_response_time));
+        events->result_received = true;
+        if (wakeup) {
+          wakeup->notify();
+        }
+      };
+    // The feedback is left in the goal's mailbox for the next tick, rather than written to
+    // the blackboard from the ROS2 node's thread. The callbacks don't refer to this node,
+    // which the goal, and the client, may outlive
+    send_goal_options.feedback_callback =
+      [events, statistics = statistics_, wakeup = wakeup_](auto, auto feedback) {
+        if (!events->feedback_received.exchange(true)) {
+          statistics->first_feedback.record(
+            std::chrono::nanoseconds(now_ns() - events->sent_time));
+        }
+        events->feedback.post(feedback);
+        if (wakeup) {
+          wakeup->notify();
+        }
+      };
+
+    statistics_->goals++;
+    events->sent_time = now_ns();
     auto future_goal_handle = action_client_->async_send_goal(goal_, send_goal_options);
 
-    if (future_goal_handle.wait_for(server_timeout_) == std::future_status::timeout) {
+    if (!yield_until(events->goal_response_received, server_timeout_)) {
+      // The server may still accept the goal, so make sure it doesn't go on without us
+      cancel_on_response(events);
+      events_.reset();
+
+      if (TickDeadline::expired()) {
+        RCLCPP_ERROR(ros2_node_->get_logger(),
+          "Deadline expired waiting for \"%s\" to accept the goal", action_name_.c_str());
+        return BT::NodeStatus::FAILURE;
+      }
       throw std::runtime_error("send_goal failed");
     }
 
     goal_handle_ = future_goal_handle.get();
+    events->release_goal_handle();
     if (!goal_handle_) {
+      statistics_->rejected++;
       throw std::runtime_error("Goal was rejected by the action server");
     }
 
     auto future_result = action_client_->async_get_result(goal_handle_);
-    std::future_status rc;
-    do {
-      rc = future_result.wait_for(server_timeout_);
-      if (rc == std::future_status::timeout) {
-        if (read_new_goal(goal_)) {
-          // If we're received a new goal on the input port, cancel the current goal
-          // and start a new one
-          auto future = action_client_->async_cancel_goal(goal_handle_);
-          if (future.wait_for(server_timeout_) == std::future_status::timeout) {
-            RCLCPP_WARN(ros2_node_->get_logger(), "failed to cancel goal");
-          } else {
-            goto new_goal_received;
-          }
+    while (!events->result_received) {
+      publish_feedback(*events);
+
+      if (read_new_goal(goal_)) {
+        // If we're received a new goal on the input port, cancel the current goal
+        // and start a new one
+        auto cancel_received = std::make_shared<std::atomic<bool>>(false);
+        action_client_->async_cancel_goal(goal_handle_,
+          [cancel_received, statistics = statistics_, requested = now_ns(),
+          wakeup = wakeup_](auto) {
+            statistics->cancel.record(std::chrono::nanoseconds(now_ns() - requested));
+            *cancel_received = true;
+            if (wakeup) {
+              wakeup->notify();
+            }
+          });
+
+        if (!yield_until(*cancel_received, server_timeout_)) {
+          RCLCPP_WARN(ros2_node_->get_logger(), "failed to cancel goal");
+        } else {
+          goto new_goal_received;
         }
+      }
 
-        // Yield to any other CoroActionNodes (coroutines)
-        setStatusRunningAndYield();
+      // Give up on the goal once the deadline has passed
+      if (TickDeadline::expired()) {
+        RCLCPP_ERROR(ros2_node_->get_logger(),
+          "Deadline expired waiting for the result of \"%s\"", action_name_.c_str());
+        cancel_goal(goal_handle_);
+        return BT::NodeStatus::FAILURE;
       }
-    } while (rc != std::future_status::ready);
+
+      // Yield to any other CoroActionNodes (coroutines)
+      setStatusRunningAndYield();
+    }
+
+    // How long the result waited for the tree to get around to it
+    statistics_->result_pickup.record(std::chrono::nanoseconds(now_ns() - events->result_time));
+
+    // Pass on any feedback that arrived along with the result
+    publish_feedback(*events);
 
     result_ = future_result.get();
     switch (result_.code) {
@@ -164,21 +295,191 @@ new_goal_received:
   }
 
   // The other (optional) override required by a BT action. In this case, we
-  // make sure to cancel the ROS2 action if it is still running.
+  // make sure to cancel the ROS2 action if it is still running. The cancel request is
+  // sent without waiting for the server to acknowledge it, so halting doesn't hold up
+  // the tick thread; the tree can wait for the outstanding cancels when it's done. If the
+  // node is halted after sending a goal but before the server has responded to it, the
+  // goal is canceled once the response arrives
   void halt() override
   {
-    if (should_cancel_goal()) {
-      auto future_cancel = action_client_->async_cancel_goal(goal_handle_);
-      if (future_cancel.wait_for(server_timeout_) != std::future_status::ready) {
-        RCLCPP_ERROR(ros2_node_->get_logger(),
-          "Failed to cancel action server for %s", action_name_.c_str());
+    if (status() == BT::NodeStatus::RUNNING) {
+      if (goal_handle_) {
+        if (should_cancel_goal()) {
+          cancel_goal(goal_handle_);
+        }
+      } else if (events_) {
+        cancel_on_response(events_);
       }
     }
 
-    CoroActionNode::halt();
+    goal_handle_.reset();
+    events_.reset();
+    PooledCoroActionNode::halt();
   }
 
 protected:
+  using GoalHandle = rclcpp_action::ClientGoalHandle<ActionT>;
+  using GoalCanceller = std::function<void (typename GoalHandle::SharedPtr)>;
+
+  // Set by the action client's callbacks, which run on the ROS2 node's thread
+  struct GoalEvents
+  {
+    std::atomic<bool> goal_response_received{false};
+    std::atomic<bool> feedback_received{false};
+    std::atomic<bool> result_received{false};
+
+    // When the goal was sent and when the server responded to it and returned its result,
+    // from now_ns(). Each is written before the flag for the event is set
+    int64_t sent_time{0};
+    std::atomic<int64_t> goal_response_time{0};
+    std::atomic<int64_t> result_time{0};
+
+    // The latest feedback for the goal from the action server, waiting for the next tick
+    LatestValueMailbox<typename ActionT::Feedback> feedback;
+
+    // The goal handle from the server's response, until the node has picked it up, and
+    // what to do with it if the node was halted before the response arrived. Guarded by
+    // the mutex, since halt() runs on the tick thread
+    std::mutex mutex;
+    typename GoalHandle::SharedPtr goal_handle;
+    GoalCanceller cancel_on_response;
+
+    // Drop the reference to the goal handle. The goal handle holds the callbacks, which
+    // hold the events, so keeping it any longer than needed would keep both alive for good
+    typename GoalHandle::SharedPtr release_goal_handle()
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return std::move(goal_handle);
+    }
+  };
+
+  static int64_t now_ns()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      TickWakeup::Clock::now().time_since_epoch()).count();
+  }
+
+  // Yield to the rest of the tree until a callback sets the flag. Returns false if the
+  // timeout, or the tick deadline, expires first
+  bool yield_until(const std::atomic<bool> & flag, std::chrono::milliseconds timeout)
+  {
+    auto timeout_time = TickWakeup::Clock::now() + timeout;
+    while (!flag) {
+      // The tick deadline is checked on each resume, since it's that of the current tick
+      auto deadline = std::min(timeout_time, TickDeadline::current());
+      if (TickWakeup::Clock::now() >= deadline) {
+        return false;
+      }
+
+      // Make sure the tree is ticked again by the deadline, even if no callback comes
+      if (wakeup_) {
+        wakeup_->notify_at(deadline);
+      }
+
+      setStatusRunningAndYield();
+    }
+    return true;
+  }
+
+  // Yield to the rest of the tree until the action server is available. Once the client
+  // has connected to the server, this only takes a lookup in the discovery cache, which
+  // notices when the server goes away. Returns false if server_timeout, or the tick
+  // deadline, expires first
+  bool yield_until_server_ready()
+  {
+    auto & discovery = ActionServerDiscovery::instance();
+    if (client_ready_ && discovery.is_available(ros2_node_, action_name_)) {
+      return true;
+    }
+
+    client_ready_ = false;
+    auto timeout_time = TickWakeup::Clock::now() + server_timeout_;
+    while (!action_client_->action_server_is_ready()) {
+      auto deadline = std::min(timeout_time, TickDeadline::current());
+      auto now = TickWakeup::Clock::now();
+      if (now >= deadline) {
+        return false;
+      }
+
+      // Discovery doesn't produce a callback, so check again shortly
+      if (wakeup_) {
+        wakeup_->notify_at(std::min(deadline, now + std::chrono::milliseconds(50)));
+      }
+
+      setStatusRunningAndYield();
+    }
+
+    client_ready_ = true;
+    return true;
+  }
+
+  // Ask the action server to cancel a goal, without waiting for it to acknowledge the
+  // request. The tree's PendingCancels keeps track of it until it does
+  void cancel_goal(typename GoalHandle::SharedPtr goal_handle)
+  {
+    make_goal_canceller()(goal_handle);
+  }
+
+  // Cancel the goal of the events once the server responds to it, or right away if the
+  // response has already arrived. The cancel counts as pending from now on, so the tree
+  // waits for it as it does for the others
+  void cancel_on_response(const std::shared_ptr<GoalEvents> & events)
+  {
+    auto cancel = make_goal_canceller();
+    typename GoalHandle::SharedPtr goal_handle;
+    {
+      std::lock_guard<std::mutex> lock(events->mutex);
+      if (!events->goal_handle) {
+        events->cancel_on_response = std::move(cancel);
+        return;
+      }
+      goal_handle = std::move(events->goal_handle);
+    }
+    cancel(goal_handle);
+  }
+
+  // The cancel request for a goal, registered with the tree's PendingCancels. A rejected
+  // goal (a null handle) has nothing to cancel. The client is held weakly, since the
+  // canceller may be left with the client's own goal response callback
+  GoalCanceller make_goal_canceller()
+  {
+    auto pending = pending_cancels_;
+    auto id = pending ? pending->add(server_timeout_) : 0;
+
+    std::weak_ptr<rclcpp_action::Client<ActionT>> client = action_client_;
+    return [client, statistics = statistics_, pending, id, logger = ros2_node_->get_logger(),
+             action_name = action_name_](typename GoalHandle::SharedPtr goal_handle) {
+             auto action_client = client.lock();
+             if (!goal_handle || !action_client) {
+               if (pending) {
+                 pending->complete(id);
+               }
+               return;
+             }
+
+             action_client->async_cancel_goal(goal_handle,
+               [statistics, requested = now_ns(), pending, id, logger, action_name](
+                 auto response) {
+                 statistics->cancel.record(std::chrono::nanoseconds(now_ns() - requested));
+                 if (response->goals_canceling.empty()) {
+                   RCLCPP_WARN(logger, "Action server for %s didn't cancel the goal",
+                     action_name.c_str());
+                 }
+                 if (pending) {
+                   pending->complete(id);
+                 }
+               });
+           };
+  }
+
+  // Write the latest feedback for a goal, if any has arrived since the last tick, to the ports
+  void publish_feedback(GoalEvents & events)
+  {
+    if (auto feedback = events.feedback.take()) {
+      write_feedback_ports(feedback);
+    }
+  }
+
   bool should_cancel_goal()
   {
     // Shut the node down if it is currently running
@@ -186,22 +487,51 @@ protected:
       return false;
     }
 
-    // Check if the goal is still in progress
+    // Check if the goal is still in progress. There's no goal until the server has
+    // responded to it
+    if (!goal_handle_) {
+      return false;
+    }
+
     auto status = goal_handle_->get_status();
     return status == action_msgs::msg::GoalStatus::STATUS_ACCEPTED ||
            status == action_msgs::msg::GoalStatus::STATUS_EXECUTING;
   }
 
+  // The basic ports, resolved when the node is created
+  InputBinding<std::string> action_name_input_;
+  InputBinding<std::chrono::milliseconds> server_timeout_input_;
+  InputBinding<std::shared_ptr<rclcpp::Node>> ros2_node_input_;
+
   typename std::shared_ptr<rclcpp_action::Client<ActionT>> action_client_;
   typename rclcpp_action::ClientGoalHandle<ActionT>::SharedPtr goal_handle_;
 
+  // The events of the goal that was sent last, if any. Null until the next goal is sent
+  std::shared_ptr<GoalEvents> events_;
+
   // The ROS node to use when calling the service
   rclcpp::Node::SharedPtr ros2_node_;
 
+  // The ROS node that the client was created with
+  rclcpp::Node::SharedPtr client_ros2_node_;
+  std::string client_action_name_;
+
+  // Whether the client has found the action server
+  bool client_ready_{false};
+
   std::string action_name_;
 
   std::chrono::milliseconds server_timeout_;
 
+  // The wakeup of the tree that is running this node
+  std::shared_ptr<TickWakeup> wakeup_;
+
+  // Where the tree keeps track of the cancel requests that haven't been acknowledged
+  std::shared_ptr<PendingCancels> pending_cancels_;
+
+  // The latency statistics for the action
+  std::shared_ptr<ActionLatencyStatistics> statistics_;
+
   typename ActionT::Goal goal_;
   typename rclcpp_action::ClientGoalHandle<ActionT>::WrappedResult result_;
 };
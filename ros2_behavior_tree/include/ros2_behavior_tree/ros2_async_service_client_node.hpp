@@ -22,16 +22,29 @@
 #include "behaviortree_cpp_v3/action_node.h"
 #include "rclcpp/rclcpp.hpp"
 #include "ros2_behavior_tree/bt_conversions.hpp"
+#include "ros2_behavior_tree/client_pool.hpp"
+#include "ros2_behavior_tree/pooled_coro_action_node.hpp"
+#include "ros2_behavior_tree/port_binding.hpp"
+#include "ros2_behavior_tree/request_coalescer.hpp"
+#include "ros2_behavior_tree/response_cache.hpp"
+#include "ros2_behavior_tree/tick_deadline.hpp"
+#include "ros2_behavior_tree/tick_wakeup.hpp"
 
 namespace ros2_behavior_tree
 {
 
 template<class ServiceT>
-class ROS2AsyncServiceClientNode : public BT::CoroActionNode
+class ROS2AsyncServiceClientNode : public PooledCoroActionNode
 {
 public:
   ROS2AsyncServiceClientNode(const std::string & name, const BT::NodeConfiguration & config)
-  : BT::CoroActionNode(name, config)
+  : PooledCoroActionNode(name, config),
+    service_name_input_(*this, "service_name"),
+    server_timeout_input_(*this, "server_timeout"),
+    ros2_node_input_(*this, "ros2_node"),
+    coalesce_input_(*this, "coalesce"),
+    batch_window_input_(*this, "batch_window"),
+    cache_ttl_input_(*this, "cache_ttl")
   {
     request_ = std::make_shared<typename ServiceT::Request>();
     response_ = std::make_shared<typename ServiceT::Response>();
@@ -39,6 +52,11 @@ public:
 
   ROS2AsyncServiceClientNode() = delete;
 
+  ~ROS2AsyncServiceClientNode()
+  {
+    halt();
+  }
+
   // Define the ports required by the ROS2AsyncServiceClient node
   static BT::PortsList augment_basic_ports(BT::PortsList additional_ports)
   {
@@ -47,7 +65,15 @@ public:
       BT::InputPort<std::chrono::milliseconds>("server_timeout",
         "The timeout value, in milliseconds, to use when waiting for service responses"),
       BT::InputPort<std::shared_ptr<rclcpp::Node>>("ros2_node",
-        "The ROS2 node to use when when creating the service")
+        "The ROS2 node to use when when creating the service"),
+      BT::InputPort<bool>("coalesce", false,
+        "Whether to share the call with identical requests to the service from other nodes"),
+      BT::InputPort<std::chrono::milliseconds>("batch_window",
+        "How long, in milliseconds, to hold a coalesced request to merge a burst of "
+        "identical requests (none if not set)"),
+      BT::InputPort<std::chrono::milliseconds>("cache_ttl",
+        "How long, in milliseconds, to answer identical requests from the cached response, "
+        "for services that are pure queries (no caching if not set)")
     };
 
     basic_ports.insert(additional_ports.begin(), additional_ports.end());
@@ -70,40 +96,124 @@ public:
   // The main override required by a BT service
   BT::NodeStatus tick() override
   {
-    if (!getInput("service_name", service_name_)) {
+    if (!service_name_input_.get(service_name_)) {
       throw BT::RuntimeError("Missing parameter [service_name] in ROS2AsyncServiceClientNode");
     }
 
-    if (!getInput<std::chrono::milliseconds>("server_timeout", server_timeout_)) {
+    if (!server_timeout_input_.get(server_timeout_)) {
       throw BT::RuntimeError("Missing parameter [server_timeout] in ROS2AsyncServiceClientNode");
     }
 
-    if (!getInput<std::shared_ptr<rclcpp::Node>>("ros2_node", ros2_node_)) {
+    if (!ros2_node_input_.get(ros2_node_)) {
       throw BT::RuntimeError("Missing parameter [ros2_node] in ROS2AsyncServiceClientNode");
     }
 
     read_input_ports(request_);
 
-    if (service_client_ == nullptr) {
-      service_client_ = ros2_node_->create_client<ServiceT>(service_name_);
+    // A tree that is reused across runs may be given a different ROS2 node or service name
+    // on a later run. Clients are shared with the other nodes using the same service
+    if (service_client_ == nullptr || ros2_node_ != client_ros2_node_ ||
+      service_name_ != client_service_name_)
+    {
+      service_client_ = ClientPool::instance().get_service_client<ServiceT>(
+        ros2_node_, service_name_);
+      client_ros2_node_ = ros2_node_;
+      client_service_name_ = service_name_;
+    }
+
+    // Answer from the cache, if caching is enabled and there's a fresh response to an
+    // identical request (see ResponseCache). As in ROS2ServiceClientNode, the key uses the
+    // client's fully resolved service name
+    std::chrono::milliseconds cache_ttl(0);
+    cache_ttl_input_.get(cache_ttl);
+
+    std::string cache_key;
+    if (cache_ttl.count() > 0) {
+      cache_key = ResponseCache::key<ServiceT>(service_client_->get_service_name(), *request_);
+      if (auto cached = ResponseCache::instance().get<ServiceT>(cache_key)) {
+        // The cached response is shared, so the derived class gets a copy of its own
+        response_ = std::make_shared<typename ServiceT::Response>(*cached);
+        write_output_ports(response_);
+        return BT::NodeStatus::SUCCESS;
+      }
+    }
+
+    // Don't wait past the deadline of the part of the tree we're in, if there is one
+    if (TickDeadline::expired()) {
+      RCLCPP_ERROR(ros2_node_->get_logger(),
+        "Deadline expired before calling service \"%s\"", service_name_.c_str());
+      return BT::NodeStatus::FAILURE;
     }
 
     // Make sure the server is actually there before continuing
-    if (!service_client_->wait_for_service(std::chrono::milliseconds(server_timeout_))) {
+    if (!service_client_->wait_for_service(TickDeadline::clamp(server_timeout_))) {
       RCLCPP_ERROR(ros2_node_->get_logger(),
         "Timed out waiting for service \"%s\" to become available", service_name_.c_str());
       return BT::NodeStatus::FAILURE;
     }
 
-    auto future_result = service_client_->async_send_request(request_);
+    // Send the request to the server, or share the call made for an identical request
+    // by another node (see RequestCoalescer). Either way, have the response wake up the
+    // tree's tick loop
+    bool coalesce = false;
+    coalesce_input_.get(coalesce);
+    std::chrono::milliseconds batch_window(0);
+    batch_window_input_.get(batch_window);
+
+    // Give up on a coalesced call on any way out of the tick but its response, including
+    // a halt, which unwinds the coroutine (see PooledCoroActionNode)
+    struct AbandonOnExit
+    {
+      std::shared_ptr<void> call;
+
+      ~AbandonOnExit()
+      {
+        if (call) {
+          RequestCoalescer::instance().abandon(call);
+        }
+      }
+    } coalesced_call;
+
+    RequestCoalescer::SharedFuture<ServiceT> future_result;
+    if (coalesce) {
+      auto handle = RequestCoalescer::instance().send_request(
+        service_client_, request_, batch_window,
+        [wakeup = TickWakeup::current()]() {
+          if (wakeup) {
+            wakeup->notify();
+          }
+        });
+      future_result = handle.future;
+      coalesced_call.call = handle.call;
+    } else {
+      future_result = service_client_->async_send_request(request_,
+          [wakeup = TickWakeup::current()](typename rclcpp::Client<ServiceT>::SharedFuture) {
+            if (wakeup) {
+              wakeup->notify();
+            }
+          });
+    }
+
     for (;; ) {
-      switch (future_result.wait_for(server_timeout_)) {
+      switch (future_result.wait_for(TickDeadline::clamp(server_timeout_))) {
         case std::future_status::ready:
+          coalesced_call.call.reset();
           response_ = future_result.get();
+          if (cache_ttl.count() > 0) {
+            // Cache a copy, as the derived class may modify the node's response
+            ResponseCache::instance().put<ServiceT>(cache_key,
+              std::make_shared<const typename ServiceT::Response>(*response_), cache_ttl);
+          }
           write_output_ports(response_);
           return BT::NodeStatus::SUCCESS;
 
         case std::future_status::timeout:
+          if (TickDeadline::expired()) {
+            RCLCPP_ERROR(ros2_node_->get_logger(),
+              "Deadline expired waiting for service \"%s\"", service_name_.c_str());
+            return BT::NodeStatus::FAILURE;
+          }
+
           // Yield to any other CoroActionNodes (coroutines)
           setStatusRunningAndYield();
           break;
@@ -115,11 +225,23 @@ public:
   }
 
 protected:
+  // The basic ports, resolved when the node is created
+  InputBinding<std::string> service_name_input_;
+  InputBinding<std::chrono::milliseconds> server_timeout_input_;
+  InputBinding<std::shared_ptr<rclcpp::Node>> ros2_node_input_;
+  InputBinding<bool> coalesce_input_;
+  InputBinding<std::chrono::milliseconds> batch_window_input_;
+  InputBinding<std::chrono::milliseconds> cache_ttl_input_;
+
   typename std::shared_ptr<rclcpp::Client<ServiceT>> service_client_;
 
   // The (non-spinning) node to use when calling the service
   rclcpp::Node::SharedPtr ros2_node_;
 
+  // The ROS node that the client was created with
+  rclcpp::Node::SharedPtr client_ros2_node_;
+  std::string client_service_name_;
+
   std::string service_name_;
 
   std::chrono::milliseconds server_timeout_;
@@ -12,26 +12,44 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
-
 #ifndef ROS2_BEHAVIOR_TREE__ROS2_SERVICE_CLIENT_NODE_HPP_
 #define ROS2_BEHAVIOR_TREE__ROS2_SERVICE_CLIENT_NODE_HPP_
 
+#include <algorithm>
 #include <string>
 #include <memory>
 
 #include "behaviortree_cpp_v3/action_node.h"
 #include "rclcpp/rclcpp.hpp"
 #include "ros2_behavior_tree/bt_conversions.hpp"
+#include "ros2_behavior_tree/client_pool.hpp"
+#include "ros2_behavior_tree/port_binding.hpp"
+#include "ros2_behavior_tree/request_coalescer.hpp"
+#include "ros2_behavior_tree/response_cache.hpp"
+#include "ros2_behavior_tree/tick_deadline.hpp"
+#include "ros2_behavior_tree/tick_wakeup.hpp"
 
 namespace ros2_behavior_tree
 {
 
+// Calls a ROS2 service. By default, the call is made synchronously, blocking the tick
+// until the response arrives. With non_blocking set, the node instead returns RUNNING
+// while the call is outstanding and checks for the response on later ticks, so that a
+// slow service doesn't hold up the rest of the tree. Unlike ROS2AsyncServiceClientNode,
+// this doesn't need a coroutine (and its stack), only a little state between ticks
 template<class ServiceT>
-class ROS2ServiceClientNode : public BT::SyncActionNode
+class ROS2ServiceClientNode : public BT::ActionNodeBase
 {
 public:
   ROS2ServiceClientNode(const std::string & name, const BT::NodeConfiguration & config)
-  : BT::SyncActionNode(name, config)
+  : BT::ActionNodeBase(name, config),
+    service_name_input_(*this, "service_name"),
+    server_timeout_input_(*this, "server_timeout"),
+    ros2_node_input_(*this, "ros2_node"),
+    coalesce_input_(*this, "coalesce"),
+    batch_window_input_(*this, "batch_window"),
+    cache_ttl_input_(*this, "cache_ttl"),
+    non_blocking_input_(*this, "non_blocking")
   {
     request_ = std::make_shared<typename ServiceT::Request>();
     response_ = std::make_shared<typename ServiceT::Response>();
@@ -39,6 +57,11 @@ public:
 
   ROS2ServiceClientNode() = delete;
 
+  ~ROS2ServiceClientNode()
+  {
+    halt();
+  }
+
   // Define the ports required by the ROS2ServiceClient node
   static BT::PortsList augment_basic_ports(BT::PortsList additional_ports)
   {
@@ -47,7 +70,17 @@ public:
       BT::InputPort<std::chrono::milliseconds>("server_timeout",
         "The timeout value, in milliseconds, to use when waiting for service responses"),
       BT::InputPort<std::shared_ptr<rclcpp::Node>>("ros2_node",
-        "The ROS2 node to use when creating the action")
+        "The ROS2 node to use when creating the action"),
+      BT::InputPort<bool>("coalesce", false,
+        "Whether to share the call with identical requests to the service from other nodes"),
+      BT::InputPort<std::chrono::milliseconds>("batch_window",
+        "How long, in milliseconds, to hold a coalesced request to merge a burst of "
+        "identical requests (none if not set)"),
+      BT::InputPort<std::chrono::milliseconds>("cache_ttl",
+        "How long, in milliseconds, to answer identical requests from the cached response, "
+        "for services that are pure queries (no caching if not set)"),
+      BT::InputPort<bool>("non_blocking", false,
+        "Whether to return RUNNING while waiting for the service, instead of blocking the tick")
     };
 
     basic_ports.insert(additional_ports.begin(), additional_ports.end());
@@ -70,62 +103,263 @@ public:
   // The main override required by a BT service
   BT::NodeStatus tick() override
   {
-    if (!getInput("service_name", service_name_)) {
+    // Carry on with a call started on an earlier tick
+    if (state_ == State::WAITING_FOR_SERVICE) {
+      return check_service();
+    }
+
+    if (state_ == State::WAITING_FOR_RESPONSE) {
+      return check_response();
+    }
+
+    if (!service_name_input_.get(service_name_)) {
       throw BT::RuntimeError("Missing parameter [service_name] in ROS2ServiceClientNode");
     }
 
-    if (!getInput<std::chrono::milliseconds>("server_timeout", server_timeout_)) {
+    if (!server_timeout_input_.get(server_timeout_)) {
       throw BT::RuntimeError("Missing parameter [server_timeout] in ROS2ServiceClientNode");
     }
 
-    if (!getInput<std::shared_ptr<rclcpp::Node>>("ros2_node", ros2_node_)) {
+    if (!ros2_node_input_.get(ros2_node_)) {
       throw BT::RuntimeError("Missing parameter [ros2_node] in ROS2ServiceClientNode");
     }
 
     read_input_ports(request_);
 
-    if (service_client_ == nullptr) {
-      service_client_ = ros2_node_->create_client<ServiceT>(service_name_);
+    // A tree that is reused across runs may be given a different ROS2 node or service name
+    // on a later run. Clients are shared with the other nodes using the same service
+    if (service_client_ == nullptr || ros2_node_ != client_ros2_node_ ||
+      service_name_ != client_service_name_)
+    {
+      service_client_ = ClientPool::instance().get_service_client<ServiceT>(
+        ros2_node_, service_name_);
+      client_ros2_node_ = ros2_node_;
+      client_service_name_ = service_name_;
+    }
+
+    // Answer from the cache, if caching is enabled and there's a fresh response to an
+    // identical request (see ResponseCache). The key uses the client's fully resolved
+    // service name, so that a relative name used from nodes in different namespaces
+    // doesn't share responses
+    cache_ttl_ = std::chrono::milliseconds(0);
+    cache_ttl_input_.get(cache_ttl_);
+
+    if (cache_ttl_.count() > 0) {
+      cache_key_ = ResponseCache::key<ServiceT>(service_client_->get_service_name(), *request_);
+      if (auto cached = ResponseCache::instance().get<ServiceT>(cache_key_)) {
+        // The cached response is shared, so the derived class gets a copy of its own
+        response_ = std::make_shared<typename ServiceT::Response>(*cached);
+        write_output_ports(response_);
+        return BT::NodeStatus::SUCCESS;
+      }
+    }
+
+    // Don't wait past the deadline of the part of the tree we're in, if there is one
+    if (TickDeadline::expired()) {
+      RCLCPP_ERROR(ros2_node_->get_logger(),
+        "Deadline expired before calling service \"%s\"", service_name_.c_str());
+      return BT::NodeStatus::FAILURE;
+    }
+
+    coalesce_ = false;
+    coalesce_input_.get(coalesce_);
+    batch_window_ = std::chrono::milliseconds(0);
+    batch_window_input_.get(batch_window_);
+
+    non_blocking_ = false;
+    non_blocking_input_.get(non_blocking_);
+
+    if (non_blocking_) {
+      wakeup_ = TickWakeup::current();
+      timeout_time_ = TickWakeup::Clock::now() + server_timeout_;
+      state_ = State::WAITING_FOR_SERVICE;
+      return check_service();
     }
 
     // Make sure the server is actually there before continuing
-    if (!service_client_->wait_for_service(std::chrono::milliseconds(server_timeout_))) {
+    if (!service_client_->wait_for_service(TickDeadline::clamp(server_timeout_))) {
       RCLCPP_ERROR(ros2_node_->get_logger(),
         "Timed out waiting for service \"%s\" to become available", service_name_.c_str());
       return BT::NodeStatus::FAILURE;
     }
 
-    // Send the request to the server
-    auto future_result = service_client_->async_send_request(request_);
+    send_request();
 
     // Wait for the response
-    auto rc = future_result.wait_for(server_timeout_);
-
+    auto rc = future_result_.wait_for(TickDeadline::clamp(server_timeout_ + batch_window_));
     if (rc == std::future_status::ready) {
-      response_ = future_result.get();
-      write_output_ports(response_);
-      return BT::NodeStatus::SUCCESS;
-    } else if (rc == std::future_status::timeout) {
+      return complete();
+    }
+
+    abandon_request();
+
+    if (rc == std::future_status::timeout) {
       RCLCPP_ERROR(ros2_node_->get_logger(), "Call to \"%s\" service timed out",
         service_name_.c_str());
-      return BT::NodeStatus::FAILURE;
     } else {
       RCLCPP_ERROR(ros2_node_->get_logger(),
         "Call to \"%s\" server failed", service_name_.c_str());
-      return BT::NodeStatus::FAILURE;
     }
+    return BT::NodeStatus::FAILURE;
+  }
+
+  // Drop an outstanding non-blocking call. The response, if it still arrives, is ignored
+  void halt() override
+  {
+    abandon_request();
+    state_ = State::IDLE;
+    setStatus(BT::NodeStatus::IDLE);
   }
 
 protected:
+  // Where a non-blocking call is between ticks
+  enum class State
+  {
+    IDLE,
+    WAITING_FOR_SERVICE,
+    WAITING_FOR_RESPONSE
+  };
+
+  // Send the request to the server, or share the call made for an identical request
+  // by another node (see RequestCoalescer). Either way, have the response wake up the
+  // tree's tick loop
+  void send_request()
+  {
+    auto wakeup = TickWakeup::current();
+    if (coalesce_) {
+      auto handle = RequestCoalescer::instance().send_request(
+        service_client_, request_, batch_window_,
+        [wakeup]() {
+          if (wakeup) {
+            wakeup->notify();
+          }
+        });
+      future_result_ = handle.future;
+      coalesced_call_ = handle.call;
+    } else {
+      future_result_ = service_client_->async_send_request(request_,
+          [wakeup](typename rclcpp::Client<ServiceT>::SharedFuture) {
+            if (wakeup) {
+              wakeup->notify();
+            }
+          });
+    }
+  }
+
+  void abandon_request()
+  {
+    if (coalesced_call_) {
+      RequestCoalescer::instance().abandon(coalesced_call_);
+      coalesced_call_.reset();
+    }
+    future_result_ = RequestCoalescer::SharedFuture<ServiceT>();
+  }
+
+  BT::NodeStatus complete()
+  {
+    state_ = State::IDLE;
+    response_ = future_result_.get();
+    coalesced_call_.reset();
+    future_result_ = RequestCoalescer::SharedFuture<ServiceT>();
+
+    if (cache_ttl_.count() > 0) {
+      // Cache a copy, as the derived class may modify the node's response
+      ResponseCache::instance().put<ServiceT>(cache_key_,
+        std::make_shared<const typename ServiceT::Response>(*response_), cache_ttl_);
+    }
+    write_output_ports(response_);
+    return BT::NodeStatus::SUCCESS;
+  }
+
+  BT::NodeStatus fail()
+  {
+    abandon_request();
+    state_ = State::IDLE;
+    return BT::NodeStatus::FAILURE;
+  }
+
+  // Non-blocking: wait for the server to become available, without holding up the tick
+  BT::NodeStatus check_service()
+  {
+    if (service_client_->service_is_ready()) {
+      send_request();
+      timeout_time_ = TickWakeup::Clock::now() + server_timeout_ + batch_window_;
+      state_ = State::WAITING_FOR_RESPONSE;
+      return check_response();
+    }
+
+    auto deadline = std::min(timeout_time_, TickDeadline::current());
+    auto now = TickWakeup::Clock::now();
+    if (now >= deadline) {
+      RCLCPP_ERROR(ros2_node_->get_logger(),
+        "Timed out waiting for service \"%s\" to become available", service_name_.c_str());
+      return fail();
+    }
+
+    // Discovery doesn't produce a callback, so check again shortly
+    if (wakeup_) {
+      wakeup_->notify_at(std::min(deadline, now + std::chrono::milliseconds(50)));
+    }
+    return BT::NodeStatus::RUNNING;
+  }
+
+  // Non-blocking: see whether the response has arrived, without holding up the tick
+  BT::NodeStatus check_response()
+  {
+    if (future_result_.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+      return complete();
+    }
+
+    auto deadline = std::min(timeout_time_, TickDeadline::current());
+    if (TickWakeup::Clock::now() >= deadline) {
+      RCLCPP_ERROR(ros2_node_->get_logger(), "Call to \"%s\" service timed out",
+        service_name_.c_str());
+      return fail();
+    }
+
+    // The response callback wakes the tree up when it arrives; this is for the timeout
+    if (wakeup_) {
+      wakeup_->notify_at(deadline);
+    }
+    return BT::NodeStatus::RUNNING;
+  }
+
+  // The basic ports, resolved when the node is created
+  InputBinding<std::string> service_name_input_;
+  InputBinding<std::chrono::milliseconds> server_timeout_input_;
+  InputBinding<std::shared_ptr<rclcpp::Node>> ros2_node_input_;
+  InputBinding<bool> coalesce_input_;
+  InputBinding<std::chrono::milliseconds> batch_window_input_;
+  InputBinding<std::chrono::milliseconds> cache_ttl_input_;
+  InputBinding<bool> non_blocking_input_;
+
   typename std::shared_ptr<rclcpp::Client<ServiceT>> service_client_;
 
   // The (non-spinning) node to use when calling the service
   rclcpp::Node::SharedPtr ros2_node_;
 
+  // The ROS node that the client was created with
+  rclcpp::Node::SharedPtr client_ros2_node_;
+  std::string client_service_name_;
+
   std::string service_name_;
 
   std::chrono::milliseconds server_timeout_;
 
+  // The options of the current call, read when it starts
+  bool coalesce_{false};
+  bool non_blocking_{false};
+  std::chrono::milliseconds batch_window_{0};
+  std::chrono::milliseconds cache_ttl_{0};
+  std::string cache_key_;
+
+  // The current call, kept between ticks when non-blocking
+  State state_{State::IDLE};
+  TickWakeup::Clock::time_point timeout_time_;
+  std::shared_ptr<TickWakeup> wakeup_;
+  RequestCoalescer::SharedFuture<ServiceT> future_result_;
+  std::shared_ptr<void> coalesced_call_;
+
   std::shared_ptr<typename ServiceT::Request> request_;
   std::shared_ptr<typename ServiceT::Response> response_;
 };
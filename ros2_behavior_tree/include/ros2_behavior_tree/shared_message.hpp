@@ -0,0 +1,40 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__SHARED_MESSAGE_HPP_
+#define ROS2_BEHAVIOR_TREE__SHARED_MESSAGE_HPP_
+
+#include <memory>
+
+namespace ros2_behavior_tree
+{
+
+//
+// Large ROS2 messages (paths, maps, point clouds) are passed between nodes on the
+// blackboard as std::shared_ptr<const Msg>, so that moving one from an action result or
+// service response to the next node's goal doesn't copy it at each hop.
+//
+
+// A pointer to a part of a message, such as the path in an action result, that keeps the
+// whole message alive. The part is put on the blackboard without copying it
+template<typename ParentT, typename MemberT>
+std::shared_ptr<const MemberT>
+share_member(const std::shared_ptr<ParentT> & parent, const MemberT & member)
+{
+  return std::shared_ptr<const MemberT>(parent, &member);
+}
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__SHARED_MESSAGE_HPP_
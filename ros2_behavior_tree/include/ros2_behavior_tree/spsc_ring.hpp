@@ -0,0 +1,110 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__SPSC_RING_HPP_
+#define ROS2_BEHAVIOR_TREE__SPSC_RING_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief A bounded, lock-free ring buffer for a single producer thread and a single
+// consumer thread. push() never blocks or allocates; when the ring is full the item is
+// rejected and it is up to the producer to account for it.
+//
+template<typename T>
+class SpscRing
+{
+public:
+  // The capacity is rounded up to a power of two
+  explicit SpscRing(size_t capacity)
+  {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    buffer_.resize(size);
+    mask_ = size - 1;
+  }
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing & operator=(const SpscRing &) = delete;
+
+  // Add an item to the ring. Returns false if the ring is full. Producer only
+  bool push(const T & item)
+  {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - cached_tail_ > mask_) {
+      // Only look at the consumer's position when the ring appears to be full
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head - cached_tail_ > mask_) {
+        return false;
+      }
+    }
+
+    buffer_[head & mask_] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Remove up to max_items from the ring into items. Returns the number removed.
+  // Consumer only
+  size_t pop(T * items, size_t max_items)
+  {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+
+    size_t count = head - tail;
+    if (count > max_items) {
+      count = max_items;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      items[i] = buffer_[(tail + i) & mask_];
+    }
+
+    tail_.store(tail + count, std::memory_order_release);
+    return count;
+  }
+
+  // Whether the ring is empty. Only exact when called by the consumer
+  bool empty() const
+  {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+  }
+
+  size_t capacity() const {return mask_ + 1;}
+
+protected:
+  static constexpr size_t cache_line_size = 64;
+
+  std::vector<T> buffer_;
+  size_t mask_;
+
+  // Keep the producer's and the consumer's positions on separate cache lines
+  char pad0_[cache_line_size];
+  std::atomic<size_t> head_{0};
+  size_t cached_tail_{0};
+  char pad1_[cache_line_size];
+  std::atomic<size_t> tail_{0};
+  char pad2_[cache_line_size];
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__SPSC_RING_HPP_
@@ -0,0 +1,54 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__THREAD_OPTIONS_HPP_
+#define ROS2_BEHAVIOR_TREE__THREAD_OPTIONS_HPP_
+
+#include <string>
+#include <vector>
+
+namespace ros2_behavior_tree
+{
+
+// How to schedule a thread, such as the one ticking a tree or spinning its ROS2 nodes, to
+// keep other work on the machine from adding jitter to a control loop
+struct ThreadOptions
+{
+  // The CPUs the thread may run on (any if empty)
+  std::vector<int> cpus;
+
+  // The SCHED_FIFO priority (1 to 99) to run the thread at, or 0 for the default policy
+  int fifo_priority{0};
+
+  // The nice value of a thread with the default policy (0 to leave it as is)
+  int nice{0};
+
+  bool is_default() const
+  {
+    return cpus.empty() && fifo_priority == 0 && nice == 0;
+  }
+};
+
+// Parse a list of CPUs, such as "2,3" or "0-3,6"
+std::vector<int> parse_cpu_list(const std::string & list);
+
+// Apply the options to the calling thread. SCHED_FIFO and negative nice values need
+// privileges (CAP_SYS_NICE or an RLIMIT_RTPRIO/RLIMIT_NICE allowance) that a process often
+// doesn't have. Any option that can't be applied is skipped with a warning, falling back
+// from SCHED_FIFO to the nice value. Returns whether all of them were applied
+bool apply_thread_options(const ThreadOptions & options);
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__THREAD_OPTIONS_HPP_
@@ -0,0 +1,65 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__TICK_DEADLINE_HPP_
+#define ROS2_BEHAVIOR_TREE__TICK_DEADLINE_HPP_
+
+#include <chrono>
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief TickDeadline is the time by which the part of the tree currently being ticked
+// should be done. It is set for the whole tree by BehaviorTree (see
+// BehaviorTree::set_execution_timeout) and narrowed for a subtree by the Deadline
+// decorator. The ROS2 client nodes clamp their waits for servers and responses to the
+// time that remains, and fail right away once it has run out, so that a sequence of
+// calls can't take longer than the budget of their parent.
+//
+// Nested deadlines can only shorten the current one, never extend it.
+//
+class TickDeadline
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // The deadline on this thread, or Clock::time_point::max() if there isn't one
+  static Clock::time_point current();
+
+  // Whether the deadline on this thread has passed
+  static bool expired();
+
+  // Shorten a timeout so that it doesn't go past the deadline on this thread
+  static std::chrono::milliseconds clamp(std::chrono::milliseconds timeout);
+
+  // Makes a deadline the current one on this thread for the lifetime of the scope, if it
+  // is earlier than the current one
+  class Scope
+  {
+public:
+    explicit Scope(Clock::time_point deadline);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope & operator=(const Scope &) = delete;
+
+private:
+    Clock::time_point previous_;
+  };
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__TICK_DEADLINE_HPP_
@@ -0,0 +1,140 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__TICK_PROFILER_HPP_
+#define ROS2_BEHAVIOR_TREE__TICK_PROFILER_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "behaviortree_cpp_v3/behavior_tree.h"
+#include "behaviortree_cpp_v3/bt_factory.h"
+
+namespace ros2_behavior_tree
+{
+
+class ProfiledTickNode;
+
+//
+// @brief The TickProfiler measures the time spent in each node of a tree. While
+// instrumented, each node of the tree (other than the root) is reached through a
+// ProfiledTickNode, which times the node's executeTick() with the steady clock and
+// accumulates the results into counters that are allocated up front.
+//
+// Only one thread may tick an instrumented tree at a time.
+//
+class TickProfiler
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // The counters kept for each node of the tree
+  struct NodeProfile
+  {
+    uint16_t uid;
+    std::string name;
+    std::string path;  // The names of the node and its ancestors, separated by ';'
+    uint64_t calls{0};
+    Clock::duration total_time{Clock::duration::zero()};
+    Clock::duration self_time{Clock::duration::zero()};
+    uint64_t running{0};
+    uint64_t success{0};
+    uint64_t failure{0};
+  };
+
+  explicit TickProfiler(BT::Tree & tree);
+  ~TickProfiler();
+
+  TickProfiler(const TickProfiler &) = delete;
+  TickProfiler & operator=(const TickProfiler &) = delete;
+
+  // Insert and remove the timing wrappers between each of the tree's nodes and its parent.
+  // The wrappers should be removed before the tree is used without the profiler
+  void instrument();
+  void restore();
+
+  // Instruments the tree for the lifetime of the scope
+  class Instrumentation
+  {
+public:
+    explicit Instrumentation(TickProfiler * profiler)
+    : profiler_(profiler)
+    {
+      if (profiler_) {
+        profiler_->instrument();
+      }
+    }
+
+    ~Instrumentation()
+    {
+      if (profiler_) {
+        profiler_->restore();
+      }
+    }
+
+    Instrumentation(const Instrumentation &) = delete;
+    Instrumentation & operator=(const Instrumentation &) = delete;
+
+private:
+    TickProfiler * profiler_;
+  };
+
+  // Tick the root node of the tree, timing it as well
+  BT::NodeStatus tick_root();
+
+  const std::vector<NodeProfile> & profiles() const {return profiles_;}
+  void clear();
+
+  // Write the results as a table, one row per node
+  void write_table(std::ostream & os) const;
+
+  // Write the results in the "folded stacks" format used by flame graph tools, with
+  // the self time of each node, in microseconds, as its sample count
+  void write_folded(std::ostream & os) const;
+
+protected:
+  friend class ProfiledTickNode;
+
+  void add_children(BT::TreeNode * node, const std::string & path);
+  size_t add_profile(BT::TreeNode * node, const std::string & parent_path);
+
+  BT::NodeStatus timed_tick(size_t index, BT::TreeNode * node);
+
+  BT::TreeNode * root_;
+  bool instrumented_{false};
+
+  std::vector<NodeProfile> profiles_;
+
+  // A wrapper for each non-root node, along with the parent that the wrapper is installed in
+  struct Wrapper
+  {
+    BT::TreeNode * parent;
+    size_t child_index;
+    BT::TreeNode * target;
+    std::unique_ptr<ProfiledTickNode> node;
+  };
+  std::vector<Wrapper> wrappers_;
+
+  // The time spent in the children of each node currently being ticked, used to
+  // compute the self time of a node
+  std::vector<Clock::duration> child_time_stack_;
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__TICK_PROFILER_HPP_
@@ -0,0 +1,53 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__TICK_STATISTICS_HPP_
+#define ROS2_BEHAVIOR_TREE__TICK_STATISTICS_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+#include "ros2_behavior_tree/latency_histogram.hpp"
+
+namespace ros2_behavior_tree
+{
+
+// Timing statistics for the tick loop of a Behavior Tree. Updated by the tick thread
+// and safe to read from any other thread
+struct TickStatistics
+{
+  // The time taken by each tick of the root node
+  LatencyHistogram tick_duration;
+
+  // How late the tick loop woke up, relative to when the next tick was scheduled
+  LatencyHistogram wakeup_jitter;
+
+  // The number of ticks
+  std::atomic<uint64_t> ticks{0};
+
+  // The number of loop iterations that took longer than the tick period
+  std::atomic<uint64_t> overruns{0};
+
+  void reset()
+  {
+    tick_duration.reset();
+    wakeup_jitter.reset();
+    ticks.store(0, std::memory_order_relaxed);
+    overruns.store(0, std::memory_order_relaxed);
+  }
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__TICK_STATISTICS_HPP_
@@ -0,0 +1,89 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__TICK_WAKEUP_HPP_
+#define ROS2_BEHAVIOR_TREE__TICK_WAKEUP_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace ros2_behavior_tree
+{
+
+//
+// @brief A TickWakeup lets nodes (and their ROS2 callbacks) tell the tick loop of a
+// Behavior Tree that something has happened and the tree should be ticked right away,
+// rather than at the next tick period.
+//
+// While a tree is being ticked, its TickWakeup is available to the nodes through
+// TickWakeup::current(). A node that expects an asynchronous event (an action result,
+// a service response, etc.) should grab it during tick() and notify it from the callback.
+//
+class TickWakeup
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  TickWakeup() = default;
+  TickWakeup(const TickWakeup &) = delete;
+  TickWakeup & operator=(const TickWakeup &) = delete;
+
+  // Request a tick as soon as possible. Safe to call from any thread
+  void notify();
+
+  // Request a tick no later than the specified time. Safe to call from any thread
+  void notify_at(Clock::time_point when);
+
+  // Forward notifications to a listener as well, such as the BehaviorTreeExecutor that
+  // ticks the tree. The listener is called, without any lock held, with the time by which
+  // a tick is wanted. Pass nullptr to remove the listener
+  using Listener = std::function<void (Clock::time_point)>;
+  void set_listener(Listener listener);
+
+  // Block until notified, a requested tick time arrives or the deadline passes.
+  // Returns true if the wait ended because of a notification
+  bool wait_until(Clock::time_point deadline);
+
+  // The wakeup of the tree currently being ticked on this thread (null if none)
+  static std::shared_ptr<TickWakeup> current();
+
+  // Makes a wakeup the current one on this thread for the lifetime of the scope
+  class Scope
+  {
+public:
+    explicit Scope(std::shared_ptr<TickWakeup> wakeup);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope & operator=(const Scope &) = delete;
+
+private:
+    std::shared_ptr<TickWakeup> previous_;
+  };
+
+protected:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+
+  bool pending_{false};
+  Clock::time_point requested_{Clock::time_point::max()};
+  Listener listener_;
+};
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__TICK_WAKEUP_HPP_
@@ -0,0 +1,158 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS2_BEHAVIOR_TREE__TRANSITION_LOG_HPP_
+#define ROS2_BEHAVIOR_TREE__TRANSITION_LOG_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ros2_behavior_tree/spsc_ring.hpp"
+
+namespace ros2_behavior_tree
+{
+
+//
+// The binary transition log file consists of a TransitionLogHeader followed by a sequence
+// of 16-byte TransitionRecords. Most records are node status changes. A record whose
+// status is TransitionRecord::node_name names a node instead: it is followed by enough
+// 16-byte blocks to hold the (unterminated) name, whose length is in the record's extra
+// field. Names may appear anywhere in the file, so readers should make two passes.
+//
+
+struct TransitionRecord
+{
+  static constexpr uint8_t node_name = 0xff;
+
+  int64_t timestamp_ns;  // Time of the status change, since the clock's epoch
+  uint16_t uid;          // BT::TreeNode::UID() of the node
+  uint8_t prev_status;   // BT::NodeStatus before the change
+  uint8_t status;        // BT::NodeStatus after the change, or node_name
+  uint32_t extra;        // The length of the name, for node_name records
+};
+
+static_assert(sizeof(TransitionRecord) == 16, "TransitionRecord must be 16 bytes");
+
+struct TransitionLogHeader
+{
+  static constexpr char magic_value[8] = {'B', 'T', 'T', 'R', 'L', 'O', 'G', '\0'};
+  static constexpr uint32_t current_version = 1;
+
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint64_t record_count;  // The number of 16-byte records written so far
+  uint64_t dropped;       // Status changes lost because the ring was full
+};
+
+static_assert(sizeof(TransitionLogHeader) == 32, "TransitionLogHeader must be 32 bytes");
+
+//
+// @brief A TransitionLogWriter accepts TransitionRecords from the tick thread through a
+// lock-free ring and has a background thread append them to a memory-mapped file, so that
+// recording a status change costs the tick thread a few stores rather than formatted I/O.
+//
+class TransitionLogWriter
+{
+public:
+  explicit TransitionLogWriter(
+    const std::string & filename,
+    size_t ring_capacity = 16384,
+    std::chrono::milliseconds drain_period = std::chrono::milliseconds(20));
+  ~TransitionLogWriter();
+
+  TransitionLogWriter(const TransitionLogWriter &) = delete;
+  TransitionLogWriter & operator=(const TransitionLogWriter &) = delete;
+
+  // Queue a status change. Never blocks on I/O; the record is dropped if the ring is full.
+  // The ring has a single consumer, and producers are serialized by a spin flag, which
+  // is uncontended unless nodes change status from their own threads
+  void record(const TransitionRecord & record)
+  {
+    while (producer_busy_.test_and_set(std::memory_order_acquire)) {
+    }
+    bool pushed = ring_.push(record);
+    producer_busy_.clear(std::memory_order_release);
+
+    if (!pushed) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Record the name of a node, once per uid
+  void add_node_name(uint16_t uid, const std::string & name);
+
+  // Block until everything recorded so far has been written to the file
+  void flush();
+
+  uint64_t dropped() const {return dropped_.load(std::memory_order_relaxed);}
+  const std::string & filename() const {return filename_;}
+
+protected:
+  void run();
+  void write_pending();
+  void discard_pending();
+  void append(const void * data, size_t size);
+  void reserve(size_t size);
+
+  std::string filename_;
+  std::chrono::milliseconds drain_period_;
+
+  SpscRing<TransitionRecord> ring_;
+  std::atomic_flag producer_busy_ = ATOMIC_FLAG_INIT;
+  std::atomic<uint64_t> dropped_{0};
+
+  // The node names waiting to be written, and the uids already named
+  std::vector<std::pair<uint16_t, std::string>> pending_names_;
+  std::unordered_set<uint16_t> named_uids_;
+
+  // The file and its current mapping. Only touched by the writer thread after construction
+  int fd_{-1};
+  char * map_{nullptr};
+  size_t map_size_{0};
+  size_t offset_{0};
+  bool failed_{false};
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable flushed_;
+  uint64_t flush_requests_{0};
+  uint64_t flushes_done_{0};
+  bool stopping_{false};
+
+  std::thread thread_;
+};
+
+// A transition log read back from a file
+struct TransitionLog
+{
+  TransitionLogHeader header;
+  std::unordered_map<uint16_t, std::string> node_names;
+  std::vector<TransitionRecord> transitions;
+};
+
+// Read a transition log file, throwing a BT::RuntimeError if it can't be read
+TransitionLog read_transition_log(const std::string & filename);
+
+}  // namespace ros2_behavior_tree
+
+#endif  // ROS2_BEHAVIOR_TREE__TRANSITION_LOG_HPP_
@@ -0,0 +1,60 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/action_latency.hpp"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ros2_behavior_tree
+{
+
+ActionLatencyRegistry &
+ActionLatencyRegistry::instance()
+{
+  static ActionLatencyRegistry registry;
+  return registry;
+}
+
+std::shared_ptr<ActionLatencyStatistics>
+ActionLatencyRegistry::get(const std::string & action_name)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto & statistics = statistics_[action_name];
+  if (statistics == nullptr) {
+    statistics = std::make_shared<ActionLatencyStatistics>();
+  }
+  return statistics;
+}
+
+std::vector<std::pair<std::string, std::shared_ptr<ActionLatencyStatistics>>>
+ActionLatencyRegistry::all() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return {statistics_.begin(), statistics_.end()};
+}
+
+void
+ActionLatencyRegistry::reset()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto & entry : statistics_) {
+    entry.second->reset();
+  }
+}
+
+}  // namespace ros2_behavior_tree
@@ -0,0 +1,113 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/action_server_discovery.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ros2_behavior_tree
+{
+
+// An action server shows up in the graph as a set of services and topics. Its
+// send_goal service is enough to tell that it is there
+static const char kSendGoalSuffix[] = "/_action/send_goal";
+
+ActionServerDiscovery &
+ActionServerDiscovery::instance()
+{
+  static ActionServerDiscovery discovery;
+  return discovery;
+}
+
+bool
+ActionServerDiscovery::is_available(
+  const rclcpp::Node::SharedPtr & node, const std::string & action_name)
+{
+  std::string name = resolve_name(node, action_name);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  refresh_if_changed(node);
+  return available_.count(name) != 0;
+}
+
+size_t
+ActionServerDiscovery::prewarm(
+  const rclcpp::Node::SharedPtr & node, const std::vector<std::string> & action_names)
+{
+  size_t count = 0;
+  for (const auto & action_name : action_names) {
+    if (is_available(node, action_name)) {
+      count++;
+    }
+  }
+  return count;
+}
+
+uint64_t
+ActionServerDiscovery::refresh_count() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return refresh_count_;
+}
+
+std::string
+ActionServerDiscovery::resolve_name(
+  const rclcpp::Node::SharedPtr & node, const std::string & action_name)
+{
+  if (!action_name.empty() && action_name[0] == '/') {
+    return action_name;
+  }
+
+  std::string ns = node->get_namespace();
+  return (ns == "/") ? ns + action_name : ns + "/" + action_name;
+}
+
+void
+ActionServerDiscovery::refresh_if_changed(const rclcpp::Node::SharedPtr & node)
+{
+  // Watch the graph through this node if the previous one has gone away. Nothing is
+  // known about the graph at that point, so it has to be looked at
+  bool changed = false;
+  if (graph_event_ == nullptr || watched_node_.expired()) {
+    watched_node_ = node;
+    graph_event_ = node->get_graph_event();
+    changed = true;
+  }
+
+  if (graph_event_->check_and_clear()) {
+    changed = true;
+  }
+
+  if (!changed) {
+    return;
+  }
+
+  available_.clear();
+  const size_t suffix_length = sizeof(kSendGoalSuffix) - 1;
+  for (const auto & service : node->get_service_names_and_types()) {
+    const std::string & service_name = service.first;
+    if (service_name.size() > suffix_length &&
+      service_name.compare(service_name.size() - suffix_length, suffix_length,
+      kSendGoalSuffix) == 0)
+    {
+      available_.insert(service_name.substr(0, service_name.size() - suffix_length));
+    }
+  }
+
+  refresh_count_++;
+}
+
+}  // namespace ros2_behavior_tree
@@ -16,11 +16,14 @@
 
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "behaviortree_cpp_v3/xml_parsing.h"
-#include "behaviortree_cpp_v3/loggers/bt_cout_logger.h"
 #include "rclcpp/rclcpp.hpp"
+#include "ros2_behavior_tree/action_server_discovery.hpp"
+#include "ros2_behavior_tree/diagnostics.hpp"
+#include "ros2_behavior_tree/plugin_registry.hpp"
 
 namespace ros2_behavior_tree
 {
@@ -30,10 +33,7 @@ BehaviorTree::BehaviorTree(
   const std::vector<std::string> & plugin_library_names)
 : xml_parser_(factory_)
 {
-  // Load any specified BT plugins
-  for (const auto & library_name : plugin_library_names) {
-    factory_.registerFromPlugin(std::string{"lib" + library_name + ".so"});
-  }
+  register_plugins(plugin_library_names);
 
   // Parse the input XML
   xml_parser_.loadFromText(bt_xml);
@@ -42,39 +42,302 @@ BehaviorTree::BehaviorTree(
   blackboard_ = BT::Blackboard::create();
 }
 
+BehaviorTree::BehaviorTree(
+  std::shared_ptr<const CompiledTree> compiled_tree,
+  const std::vector<std::string> & plugin_library_names)
+: xml_parser_(factory_), compiled_tree_(compiled_tree)
+{
+  register_plugins(plugin_library_names);
+
+  // Create a blackboard for this Behavior Tree
+  blackboard_ = BT::Blackboard::create();
+}
+
+void
+BehaviorTree::register_plugins(const std::vector<std::string> & plugin_library_names)
+{
+  // Register the nodes from any specified BT plugins. Each library is only loaded the
+  // first time it is used in this process
+  for (const auto & library_name : plugin_library_names) {
+    PluginRegistry::instance().register_nodes(factory_, library_name);
+  }
+}
+
+void
+BehaviorTree::prepare()
+{
+  // Create the corresponding Behavior Tree, unless we've already got one
+  if (tree_ == nullptr) {
+    // Any profile is for the nodes of the previous tree
+    profiler_.reset();
+    if (compiled_tree_ != nullptr) {
+      tree_ = std::make_unique<BT::Tree>(compiled_tree_->instantiate(factory_, blackboard_));
+    } else {
+      tree_ = std::make_unique<BT::Tree>(xml_parser_.instantiateTree(blackboard_));
+    }
+
+    // Note where the nodes write their outputs, for clear_outputs()
+    output_entries_.clear();
+    for (const auto & node : tree_->nodes) {
+      for (const auto & port : node->config().output_ports) {
+        const std::string & remapping = port.second;
+        if (remapping == "=") {
+          output_entries_.emplace_back(node->config().blackboard, port.first);
+        } else if (BT::TreeNode::isBlackboardPointer(remapping)) {
+          auto key = BT::TreeNode::stripBlackboardPointer(remapping);
+          output_entries_.emplace_back(
+            node->config().blackboard, std::string(key.data(), key.size()));
+        }
+      }
+    }
+  }
+}
+
+size_t
+BehaviorTree::prewarm_action_servers(const rclcpp::Node::SharedPtr & node)
+{
+  prepare();
+
+  std::vector<std::string> action_names;
+  for (const auto & tree_node : tree_->nodes) {
+    const auto & input_ports = tree_node->config().input_ports;
+    auto it = input_ports.find("action_name");
+    if (it != input_ports.end() && !BT::TreeNode::isBlackboardPointer(it->second)) {
+      action_names.push_back(it->second);
+    }
+  }
+
+  return ActionServerDiscovery::instance().prewarm(node, action_names);
+}
+
+void
+BehaviorTree::reset()
+{
+  // Halting the root recursively halts any running nodes and sets all nodes to IDLE
+  if (tree_ != nullptr) {
+    tree_->root_node->halt();
+  }
+}
+
+void
+BehaviorTree::clear_outputs()
+{
+  // An empty value reads as a missing one, through getInput() or a port binding
+  for (const auto & entry : output_entries_) {
+    if (BT::Any * value = entry.first->getAny(entry.second)) {
+      *value = BT::Any();
+    }
+  }
+}
+
 BtStatus
 BehaviorTree::execute(
   std::function<bool()> should_halt,
   std::function<void()> on_loop_iteration,
   std::chrono::milliseconds tick_period)
 {
-  // Create the corresponding Behavior Tree
-  BT::Tree tree = xml_parser_.instantiateTree(blackboard_);
+  if (!thread_options_.is_default() && std::this_thread::get_id() != scheduled_thread_) {
+    apply_thread_options(thread_options_);
+    scheduled_thread_ = std::this_thread::get_id();
+  }
+
+  begin_execution(tick_period);
+  BtStatus status = run(should_halt, on_loop_iteration);
+  end_execution();
+
+  return status;
+}
+
+void
+BehaviorTree::begin_execution(std::chrono::milliseconds tick_period)
+{
+  prepare();
+
+  // A reused tree may have been left in a non-IDLE state by the previous run
+  reset();
+
+  execution_ = std::make_unique<Execution>();
+  execution_->tick_period = tick_period;
+  execution_->next_tick = TickWakeup::Clock::now();
+  execution_->deadline = execution_timeout_.count() > 0 ?
+    TickDeadline::Clock::now() + execution_timeout_ : TickDeadline::Clock::time_point::max();
 
-  BT::StdCoutLogger logger(tree);
+  BT::Tree & tree = *tree_;
 
+  if (console_logging_) {
+    execution_->console_logger = std::make_unique<BT::StdCoutLogger>(tree);
+  }
+
+  if (transition_log_ != nullptr) {
+    execution_->transition_logger =
+      std::make_unique<BinaryTransitionLogger>(tree, transition_log_);
+  }
+
+  // Insert the profiler's timing wrappers for the duration of the execution. This is done
+  // after the loggers have subscribed to the nodes, so that they don't see the wrappers
+  if (profiling_) {
+    if (profiler_ == nullptr) {
+      profiler_ = std::make_unique<TickProfiler>(tree);
+    }
+    execution_->instrumentation = std::make_unique<TickProfiler::Instrumentation>(
+      profiler_.get());
+    execution_->profiling = true;
+  }
+}
+
+BT::NodeStatus
+BehaviorTree::tick_once()
+{
+  auto tick_start = TickWakeup::Clock::now();
+  tick_statistics_.wakeup_jitter.record(
+    tick_start > execution_->next_tick ?
+    tick_start - execution_->next_tick : TickWakeup::Clock::duration::zero());
+
+  // Execute one tick of the tree, making the tree's wakeup, pending cancels and deadline
+  // available to the nodes
+  BT::NodeStatus result;
+  {
+    TickWakeup::Scope wakeup_scope(wakeup_);
+    PendingCancels::Scope pending_cancels_scope(pending_cancels_);
+    TickDeadline::Scope deadline_scope(execution_->deadline);
+    result = execution_->profiling ? profiler_->tick_root() : tree_->root_node->executeTick();
+  }
+
+  auto tick_end = TickWakeup::Clock::now();
+  tick_statistics_.tick_duration.record(tick_end - tick_start);
+  tick_statistics_.ticks.fetch_add(1, std::memory_order_relaxed);
+
+  execution_->next_tick = tick_start + execution_->tick_period;
+  if (tick_end > execution_->next_tick) {
+    tick_statistics_.overruns.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  return result;
+}
+
+void
+BehaviorTree::halt_execution()
+{
+  tree_->root_node->halt();
+}
+
+void
+BehaviorTree::end_execution()
+{
+  if (cancel_timeout_.count() > 0 && !pending_cancels_->wait_all(cancel_timeout_)) {
+    RCLCPP_WARN(rclcpp::get_logger("BehaviorTree"),
+      "%zu goal cancel(s) not acknowledged within %ld ms", pending_cancels_->pending(),
+      static_cast<long>(cancel_timeout_.count()));
+  }
+
+  execution_.reset();
+
+  if (!reuse_tree_) {
+    tree_.reset();
+  }
+}
+
+BtStatus
+BehaviorTree::run(std::function<bool()> should_halt, std::function<void()> on_loop_iteration)
+{
   // Set up a loop rate controller based on the desired tick period
-  rclcpp::WallRate loop_rate(tick_period);
+  rclcpp::WallRate loop_rate(execution_->tick_period);
 
   // Loop until something happens with ROS or the node completes
   BT::NodeStatus result = BT::NodeStatus::RUNNING;
   while (rclcpp::ok() && result == BT::NodeStatus::RUNNING) {
     if (should_halt()) {
-      tree.root_node->halt();
+      halt_execution();
       return BtStatus::HALTED;
     }
 
-    // Execute one tick of the tree
-    result = tree.root_node->executeTick();
+    result = tick_once();
+
+    // Give up once the execution's time budget has run out
+    if (result == BT::NodeStatus::RUNNING && execution_timed_out()) {
+      RCLCPP_WARN(rclcpp::get_logger("BehaviorTree"),
+        "Execution timed out after %ld ms", static_cast<long>(execution_timeout_.count()));
+      halt_execution();
+      return BtStatus::FAILED;
+    }
 
     // Give the caller a chance to do something on each loop iteration
     on_loop_iteration();
 
-    // Throttle the BT loop rate, based on the provided tick period value
-    loop_rate.sleep();
+    if (wake_on_event_) {
+      // Wait for the next tick period, unless one of the nodes wakes us up sooner
+      wakeup_->wait_until(execution_->next_tick);
+    } else {
+      // Throttle the BT loop rate, based on the provided tick period value
+      loop_rate.sleep();
+    }
   }
 
   return (result == BT::NodeStatus::SUCCESS) ? BtStatus::SUCCEEDED : BtStatus::FAILED;
 }
 
+void
+BehaviorTree::set_transition_log(const std::string & filename)
+{
+  transition_log_.reset();
+  if (!filename.empty()) {
+    transition_log_ = std::make_shared<TransitionLogWriter>(filename);
+  }
+}
+
+void
+BehaviorTree::write_profile(std::ostream & os) const
+{
+  if (profiler_ != nullptr) {
+    profiler_->write_table(os);
+  }
+}
+
+void
+BehaviorTree::write_profile_folded(std::ostream & os) const
+{
+  if (profiler_ != nullptr) {
+    profiler_->write_folded(os);
+  }
+}
+
+void
+BehaviorTree::publish_tick_statistics(
+  rclcpp::Node::SharedPtr node,
+  std::chrono::milliseconds period,
+  const std::string & topic)
+{
+  tick_statistics_pub_ = node->create_publisher<diagnostic_msgs::msg::DiagnosticArray>(topic, 1);
+
+  // The statistics are atomics, so they can be read here while the tree is being ticked.
+  // Hold the node weakly, since the node owns the timer
+  std::weak_ptr<rclcpp::Node> weak_node = node;
+  tick_statistics_timer_ = node->create_wall_timer(period,
+      [this, weak_node]() {
+        auto node = weak_node.lock();
+        if (!node) {
+          return;
+        }
+
+        diagnostic_msgs::msg::DiagnosticStatus status;
+        status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+        status.name = std::string(node->get_name()) + ": behavior tree tick loop";
+
+        auto ticks = tick_statistics_.ticks.load(std::memory_order_relaxed);
+        auto overruns = tick_statistics_.overruns.load(std::memory_order_relaxed);
+        add_diagnostic_value(status.values, "ticks", std::to_string(ticks));
+        add_diagnostic_value(status.values, "overruns", std::to_string(overruns));
+        add_diagnostic_values(status.values, "tick duration", tick_statistics_.tick_duration);
+        add_diagnostic_values(status.values, "wakeup jitter", tick_statistics_.wakeup_jitter);
+
+        diagnostic_msgs::msg::DiagnosticArray array;
+        array.header.stamp = node->now();
+        array.status.push_back(status);
+        add_action_latency_statuses(array.status, node->get_name());
+        add_request_coalescer_status(array.status, node->get_name());
+        add_response_cache_status(array.status, node->get_name());
+        tick_statistics_pub_->publish(array);
+      });
+}
+
 }  // namespace ros2_behavior_tree
@@ -0,0 +1,349 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/behavior_tree_executor.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace ros2_behavior_tree
+{
+
+BehaviorTreeExecutor::BehaviorTreeExecutor(unsigned int num_threads)
+{
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // Create all of the workers before starting any, since they steal from each other
+  for (unsigned int i = 0; i < num_threads; i++) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+
+  for (size_t i = 0; i < workers_.size(); i++) {
+    workers_[i]->thread = std::thread(&BehaviorTreeExecutor::worker_loop, this, i);
+  }
+}
+
+BehaviorTreeExecutor::~BehaviorTreeExecutor()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+
+  for (auto & worker : workers_) {
+    worker->thread.join();
+  }
+
+  // The workers are gone, so whatever is left can be halted from this thread
+  std::unordered_set<TaskPtr> tasks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks = tasks_;
+  }
+
+  for (const auto & task : tasks) {
+    if (task->started) {
+      task->bt->halt_execution();
+    }
+    complete(task, BtStatus::HALTED);
+  }
+}
+
+void
+BehaviorTreeExecutor::submit(
+  std::shared_ptr<BehaviorTree> bt,
+  CompletionCallback on_completion,
+  const Options & options)
+{
+  auto task = std::make_shared<Task>();
+  task->bt = bt;
+  task->on_completion = on_completion;
+  task->options = options;
+
+  // Have the tree's nodes reschedule it when they get an event
+  if (bt->wake_on_event()) {
+    std::weak_ptr<Task> weak_task = task;
+    bt->wakeup()->set_listener(
+      [this, weak_task](Clock::time_point when) {
+        wake_task(weak_task, when);
+      });
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.insert(task);
+    schedule(task, Clock::now());
+  }
+  cv_.notify_one();
+}
+
+size_t
+BehaviorTreeExecutor::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tasks_.size();
+}
+
+void
+BehaviorTreeExecutor::worker_loop(size_t index)
+{
+  for (;; ) {
+    TaskPtr task = pop_ready(index);
+    if (task == nullptr) {
+      task = steal(index);
+    }
+
+    if (task != nullptr) {
+      step(std::move(task));
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_) {
+      return;
+    }
+
+    // Take everything that is due. If there is more than one, wake up the other workers
+    // so that they can steal some of it
+    size_t promoted = promote_due_tasks(index, Clock::now());
+    if (promoted > 1) {
+      cv_.notify_all();
+    }
+
+    if (promoted > 0 || ready_count_.load() > 0) {
+      continue;
+    }
+
+    if (timers_.empty()) {
+      cv_.wait(lock);
+    } else {
+      cv_.wait_until(lock, timers_.top().deadline);
+    }
+  }
+}
+
+BehaviorTreeExecutor::TaskPtr
+BehaviorTreeExecutor::pop_ready(size_t index)
+{
+  Worker & worker = *workers_[index];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+
+  if (worker.ready.empty()) {
+    return nullptr;
+  }
+
+  std::pop_heap(worker.ready.begin(), worker.ready.end());
+  TaskPtr task = std::move(worker.ready.back().task);
+  worker.ready.pop_back();
+  ready_count_.fetch_sub(1);
+  return task;
+}
+
+BehaviorTreeExecutor::TaskPtr
+BehaviorTreeExecutor::steal(size_t index)
+{
+  for (size_t i = 1; i < workers_.size(); i++) {
+    TaskPtr task = pop_ready((index + i) % workers_.size());
+    if (task != nullptr) {
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+bool
+BehaviorTreeExecutor::schedule(const TaskPtr & task, Clock::time_point deadline)
+{
+  bool earliest = timers_.empty() || deadline < timers_.top().deadline;
+
+  task->scheduled = true;
+  task->deadline = deadline;
+  task->generation++;
+  timers_.push(Timer{deadline, task->options.priority, task->generation, task});
+
+  return earliest;
+}
+
+size_t
+BehaviorTreeExecutor::promote_due_tasks(size_t index, Clock::time_point now)
+{
+  Worker & worker = *workers_[index];
+  size_t promoted = 0;
+
+  while (!timers_.empty() && timers_.top().deadline <= now) {
+    Timer timer = timers_.top();
+    timers_.pop();
+
+    const TaskPtr & task = timer.task;
+    if (!task->scheduled || task->generation != timer.generation) {
+      continue;
+    }
+    task->scheduled = false;
+
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.ready.push_back(Ready{task->options.priority, task->deadline, task});
+    std::push_heap(worker.ready.begin(), worker.ready.end());
+    ready_count_.fetch_add(1);
+    promoted++;
+  }
+
+  return promoted;
+}
+
+void
+BehaviorTreeExecutor::wake_task(const std::weak_ptr<Task> & weak_task, Clock::time_point when)
+{
+  auto task = weak_task.lock();
+  if (task == nullptr) {
+    return;
+  }
+
+  bool earliest = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (task->done) {
+      return;
+    }
+
+    if (task->scheduled) {
+      if (when < task->deadline) {
+        earliest = schedule(task, when);
+      }
+    } else {
+      // The task is being ticked, or about to be, so just note when to tick it next
+      task->woken = std::min(task->woken, when);
+    }
+  }
+
+  if (earliest) {
+    cv_.notify_one();
+  }
+}
+
+void
+BehaviorTreeExecutor::step(TaskPtr task)
+{
+  BehaviorTree & bt = *task->bt;
+  const Options & options = task->options;
+
+  // A tree that throws (on creation, or from one of its nodes) fails, instead of taking
+  // down the worker thread along with every other tree it's executing
+  if (!task->started) {
+    try {
+      bt.begin_execution(options.tick_period);
+    } catch (const std::exception & ex) {
+      fail(task, ex.what());
+      return;
+    }
+    task->started = true;
+  }
+
+  if (!rclcpp::ok()) {
+    bt.halt_execution();
+    complete(task, BtStatus::FAILED);
+    return;
+  }
+
+  if (options.should_halt && options.should_halt()) {
+    bt.halt_execution();
+    complete(task, BtStatus::HALTED);
+    return;
+  }
+
+  BT::NodeStatus result;
+  try {
+    result = bt.tick_once();
+  } catch (const std::exception & ex) {
+    fail(task, ex.what());
+    return;
+  }
+
+  if (options.on_loop_iteration) {
+    options.on_loop_iteration();
+  }
+
+  if (result != BT::NodeStatus::RUNNING) {
+    complete(task, result == BT::NodeStatus::SUCCESS ? BtStatus::SUCCEEDED : BtStatus::FAILED);
+    return;
+  }
+
+  // Give up once the execution's time budget has run out
+  if (bt.execution_timed_out()) {
+    bt.halt_execution();
+    complete(task, BtStatus::FAILED);
+    return;
+  }
+
+  // Schedule the next tick for the end of the tick period, or sooner if one of the
+  // tree's nodes asked for it while this tick was in progress
+  bool earliest;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto deadline = std::min(bt.next_tick_time(), task->woken);
+    task->woken = Clock::time_point::max();
+    earliest = schedule(task, deadline);
+  }
+
+  if (earliest) {
+    cv_.notify_one();
+  }
+}
+
+void
+BehaviorTreeExecutor::fail(const TaskPtr & task, const char * what)
+{
+  RCLCPP_ERROR(rclcpp::get_logger("BehaviorTreeExecutor"),
+    "Behavior tree failed with an exception: %s", what);
+
+  // Halt whatever the tree left running. A tree that didn't get to start has nothing to halt
+  if (task->started) {
+    try {
+      task->bt->halt_execution();
+    } catch (const std::exception & ex) {
+      RCLCPP_ERROR(rclcpp::get_logger("BehaviorTreeExecutor"),
+        "Failed to halt the behavior tree: %s", ex.what());
+    }
+  }
+
+  complete(task, BtStatus::FAILED);
+}
+
+void
+BehaviorTreeExecutor::complete(const TaskPtr & task, BtStatus status)
+{
+  if (task->started) {
+    task->bt->end_execution();
+  }
+
+  task->bt->wakeup()->set_listener(nullptr);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task->done = true;
+    tasks_.erase(task);
+  }
+
+  if (task->on_completion) {
+    task->on_completion(status);
+  }
+}
+
+}  // namespace ros2_behavior_tree
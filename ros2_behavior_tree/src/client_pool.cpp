@@ -0,0 +1,68 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/client_pool.hpp"
+
+namespace ros2_behavior_tree
+{
+
+ClientPool &
+ClientPool::instance()
+{
+  static ClientPool pool;
+  return pool;
+}
+
+size_t
+ClientPool::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  size_t count = 0;
+  for (const auto & entry : clients_) {
+    if (!entry.second.client.expired()) {
+      count++;
+    }
+  }
+  return count;
+}
+
+uint64_t
+ClientPool::created() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return created_;
+}
+
+uint64_t
+ClientPool::reused() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return reused_;
+}
+
+void
+ClientPool::remove_expired()
+{
+  requests_since_pruned_ = 0;
+  for (auto it = clients_.begin(); it != clients_.end(); ) {
+    if (it->second.client.expired() || it->second.node.expired()) {
+      it = clients_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace ros2_behavior_tree
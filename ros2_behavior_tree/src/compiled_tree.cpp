@@ -0,0 +1,266 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/compiled_tree.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "behaviortree_cpp_v3/control_node.h"
+#include "behaviortree_cpp_v3/decorator_node.h"
+#include "behaviortree_cpp_v3/exceptions.h"
+
+namespace ros2_behavior_tree
+{
+
+constexpr char CompiledTreeHeader::magic_value[8];
+constexpr uint32_t CompiledTreeHeader::current_version;
+constexpr uint32_t CompiledTreeNode::no_parent;
+
+namespace
+{
+
+// Builds up the sections of a compiled tree
+class Compiler
+{
+public:
+  void add_node(const BT::TreeNode * node, uint32_t parent)
+  {
+    if (node->type() == BT::NodeType::SUBTREE) {
+      throw BT::RuntimeError("Can't compile SubTree node [" + node->name() +
+              "]; only a single BehaviorTree is supported");
+    }
+
+    uint32_t index = static_cast<uint32_t>(nodes_.size());
+
+    CompiledTreeNode compiled;
+    compiled.id = add_string(node->registrationName());
+    compiled.name = add_string(node->name());
+    compiled.parent = parent;
+    compiled.first_port = static_cast<uint32_t>(ports_.size());
+    compiled.port_count = 0;
+
+    // Sort the ports by name so that the output doesn't depend on hash map ordering
+    const auto & config = node->config();
+    std::map<std::string, std::pair<std::string, BT::PortDirection>> ports;
+    for (const auto & port : config.input_ports) {
+      ports[port.first] = {port.second, BT::PortDirection::INPUT};
+    }
+    for (const auto & port : config.output_ports) {
+      auto it = ports.find(port.first);
+      if (it != ports.end()) {
+        it->second.second = BT::PortDirection::INOUT;
+      } else {
+        ports[port.first] = {port.second, BT::PortDirection::OUTPUT};
+      }
+    }
+
+    for (const auto & port : ports) {
+      CompiledTreePort compiled_port;
+      compiled_port.key = add_string(port.first);
+      compiled_port.value = add_string(port.second.first);
+      compiled_port.direction = static_cast<uint32_t>(port.second.second);
+      ports_.push_back(compiled_port);
+      compiled.port_count++;
+    }
+
+    nodes_.push_back(compiled);
+
+    // Continue depth-first, so that each node's children follow it in order
+    if (auto control = dynamic_cast<const BT::ControlNode *>(node)) {
+      for (const auto child : control->children()) {
+        add_node(child, index);
+      }
+    } else if (auto decorator = dynamic_cast<const BT::DecoratorNode *>(node)) {
+      if (decorator->child() != nullptr) {
+        add_node(decorator->child(), index);
+      }
+    }
+  }
+
+  std::string output() const
+  {
+    CompiledTreeHeader header{};
+    std::memcpy(header.magic, CompiledTreeHeader::magic_value, sizeof(header.magic));
+    header.version = CompiledTreeHeader::current_version;
+    header.node_count = static_cast<uint32_t>(nodes_.size());
+    header.port_count = static_cast<uint32_t>(ports_.size());
+    header.strings_size = static_cast<uint32_t>(strings_.size());
+
+    std::string output;
+    output.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    output.append(reinterpret_cast<const char *>(nodes_.data()),
+      nodes_.size() * sizeof(CompiledTreeNode));
+    output.append(reinterpret_cast<const char *>(ports_.data()),
+      ports_.size() * sizeof(CompiledTreePort));
+    output.append(strings_);
+    return output;
+  }
+
+protected:
+  uint32_t add_string(const std::string & value)
+  {
+    auto it = string_offsets_.find(value);
+    if (it != string_offsets_.end()) {
+      return it->second;
+    }
+
+    uint32_t offset = static_cast<uint32_t>(strings_.size());
+    strings_.append(value);
+    strings_.push_back('\0');
+    string_offsets_[value] = offset;
+    return offset;
+  }
+
+  std::vector<CompiledTreeNode> nodes_;
+  std::vector<CompiledTreePort> ports_;
+  std::string strings_;
+  std::unordered_map<std::string, uint32_t> string_offsets_;
+};
+
+}  // namespace
+
+CompiledTree::CompiledTree(const std::string & filename)
+{
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw BT::RuntimeError("Could not open " + filename + ": " + std::strerror(errno));
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(CompiledTreeHeader)) {
+    ::close(fd);
+    throw BT::RuntimeError(filename + " is not a compiled tree");
+  }
+
+  size_ = st.st_size;
+  map_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map_ == MAP_FAILED) {
+    map_ = nullptr;
+    throw BT::RuntimeError("Could not map " + filename + ": " + std::strerror(errno));
+  }
+
+  // Check the file thoroughly once, so that instantiate() doesn't need to
+  const char * data = static_cast<const char *>(map_);
+  header_ = reinterpret_cast<const CompiledTreeHeader *>(data);
+  nodes_ = reinterpret_cast<const CompiledTreeNode *>(data + sizeof(CompiledTreeHeader));
+  ports_ = reinterpret_cast<const CompiledTreePort *>(nodes_ + header_->node_count);
+  strings_ = reinterpret_cast<const char *>(ports_ + header_->port_count);
+
+  uint64_t expected_size = sizeof(CompiledTreeHeader) +
+    uint64_t(header_->node_count) * sizeof(CompiledTreeNode) +
+    uint64_t(header_->port_count) * sizeof(CompiledTreePort) + header_->strings_size;
+
+  bool valid =
+    std::memcmp(header_->magic, CompiledTreeHeader::magic_value, sizeof(header_->magic)) == 0 &&
+    header_->version == CompiledTreeHeader::current_version &&
+    header_->node_count > 0 && expected_size == size_ &&
+    header_->strings_size > 0 && strings_[header_->strings_size - 1] == '\0';
+
+  for (uint32_t i = 0; valid && i < header_->node_count; i++) {
+    const auto & node = nodes_[i];
+    valid = node.id < header_->strings_size && node.name < header_->strings_size &&
+      (i == 0 ? node.parent == CompiledTreeNode::no_parent : node.parent < i) &&
+      uint64_t(node.first_port) + node.port_count <= header_->port_count;
+  }
+
+  for (uint32_t i = 0; valid && i < header_->port_count; i++) {
+    const auto & port = ports_[i];
+    valid = port.key < header_->strings_size && port.value < header_->strings_size &&
+      port.direction <= static_cast<uint32_t>(BT::PortDirection::INOUT);
+  }
+
+  if (!valid) {
+    ::munmap(map_, size_);
+    map_ = nullptr;
+    throw BT::RuntimeError(filename + " is not a valid compiled tree");
+  }
+}
+
+CompiledTree::~CompiledTree()
+{
+  if (map_ != nullptr) {
+    ::munmap(map_, size_);
+  }
+}
+
+BT::Tree
+CompiledTree::instantiate(
+  const BT::BehaviorTreeFactory & factory, const BT::Blackboard::Ptr & blackboard) const
+{
+  BT::Tree tree;
+  tree.blackboard_stack.push_back(blackboard);
+  tree.nodes.reserve(header_->node_count);
+
+  for (uint32_t i = 0; i < header_->node_count; i++) {
+    const auto & compiled = nodes_[i];
+
+    BT::NodeConfiguration config;
+    config.blackboard = blackboard;
+
+    for (uint32_t p = compiled.first_port; p < compiled.first_port + compiled.port_count; p++) {
+      const auto & port = ports_[p];
+      auto direction = static_cast<BT::PortDirection>(port.direction);
+
+      if (direction != BT::PortDirection::OUTPUT) {
+        config.input_ports[string(port.key)] = string(port.value);
+      }
+      if (direction != BT::PortDirection::INPUT) {
+        config.output_ports[string(port.key)] = string(port.value);
+      }
+    }
+
+    BT::TreeNode::Ptr node =
+      factory.instantiateTreeNode(string(compiled.name), string(compiled.id), config);
+
+    if (compiled.parent != CompiledTreeNode::no_parent) {
+      BT::TreeNode * parent = tree.nodes[compiled.parent].get();
+
+      if (auto control = dynamic_cast<BT::ControlNode *>(parent)) {
+        control->addChild(node.get());
+      } else if (auto decorator = dynamic_cast<BT::DecoratorNode *>(parent)) {
+        decorator->setChild(node.get());
+      } else {
+        throw BT::RuntimeError(
+                "Node [" + parent->name() + "] in compiled tree can't have children");
+      }
+    }
+
+    tree.nodes.push_back(node);
+  }
+
+  tree.root_node = tree.nodes.front().get();
+  return tree;
+}
+
+std::string
+CompiledTree::compile(const BT::Tree & tree)
+{
+  Compiler compiler;
+  compiler.add_node(tree.root_node, CompiledTreeNode::no_parent);
+  return compiler.output();
+}
+
+}  // namespace ros2_behavior_tree
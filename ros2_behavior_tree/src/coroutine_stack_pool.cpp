@@ -0,0 +1,160 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/coroutine_stack_pool.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <new>
+
+namespace ros2_behavior_tree
+{
+
+static size_t
+page_size()
+{
+  static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+CoroutineStackPool &
+CoroutineStackPool::instance()
+{
+  static CoroutineStackPool pool;
+  return pool;
+}
+
+CoroutineStackPool::~CoroutineStackPool()
+{
+  for (const auto & stack : free_) {
+    unmap_stack(stack);
+  }
+}
+
+void
+CoroutineStackPool::configure(const Options & options)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  options_ = options;
+
+  for (const auto & stack : free_) {
+    unmap_stack(stack);
+  }
+  free_.clear();
+}
+
+CoroutineStackPool::Options
+CoroutineStackPool::options() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return options_;
+}
+
+CoroutineStackPool::Stack
+CoroutineStackPool::acquire()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  Stack stack;
+  if (!free_.empty()) {
+    stack = free_.back();
+    free_.pop_back();
+    reused_++;
+  } else {
+    stack = map_stack();
+    created_++;
+  }
+
+  in_use_++;
+  return stack;
+}
+
+void
+CoroutineStackPool::release(const Stack & stack)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  in_use_--;
+
+  // Keep the stack unless the options have changed since it was mapped
+  auto size = (options_.stack_size + page_size() - 1) / page_size() * page_size();
+  if (stack.size == size && stack.guard_page == options_.guard_page &&
+    free_.size() < options_.max_free)
+  {
+    free_.push_back(stack);
+  } else {
+    unmap_stack(stack);
+  }
+}
+
+size_t
+CoroutineStackPool::in_use() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return in_use_;
+}
+
+size_t
+CoroutineStackPool::free() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return free_.size();
+}
+
+uint64_t
+CoroutineStackPool::created() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return created_;
+}
+
+uint64_t
+CoroutineStackPool::reused() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return reused_;
+}
+
+CoroutineStackPool::Stack
+CoroutineStackPool::map_stack() const
+{
+  Stack stack;
+  stack.size = (options_.stack_size + page_size() - 1) / page_size() * page_size();
+  stack.guard_page = options_.guard_page;
+
+  size_t guard = stack.guard_page ? page_size() : 0;
+  void * memory = mmap(nullptr, stack.size + guard, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (memory == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+
+  // Stacks grow down, so the guard page goes at the low end
+  if (guard != 0 && mprotect(memory, guard, PROT_NONE) != 0) {
+    munmap(memory, stack.size + guard);
+    throw std::bad_alloc();
+  }
+
+  stack.base = static_cast<char *>(memory) + guard;
+  return stack;
+}
+
+void
+CoroutineStackPool::unmap_stack(const Stack & stack)
+{
+  size_t guard = stack.guard_page ? page_size() : 0;
+  munmap(static_cast<char *>(stack.base) - guard, stack.size + guard);
+}
+
+}  // namespace ros2_behavior_tree
@@ -0,0 +1,149 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/executor_service.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace ros2_behavior_tree
+{
+
+ExecutorService &
+ExecutorService::instance()
+{
+  return *shared_instance();
+}
+
+std::shared_ptr<ExecutorService>
+ExecutorService::shared_instance()
+{
+  static std::shared_ptr<ExecutorService> service(new ExecutorService());
+  return service;
+}
+
+ExecutorService::~ExecutorService()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  stop();
+}
+
+ExecutorService::Registration::Registration(
+  std::shared_ptr<ExecutorService> service,
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node)
+: service_(std::move(service)), node_(std::move(node))
+{
+}
+
+ExecutorService::Registration::~Registration()
+{
+  service_->remove_node(node_);
+}
+
+std::unique_ptr<ExecutorService::Registration>
+ExecutorService::add_node(rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  stop();
+  nodes_.push_back(node);
+  start();
+
+  return std::unique_ptr<Registration>(new Registration(shared_instance(), node));
+}
+
+void
+ExecutorService::remove_node(const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr & node)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = std::find(nodes_.begin(), nodes_.end(), node);
+  if (it == nodes_.end()) {
+    return;
+  }
+
+  stop();
+  nodes_.erase(it);
+  if (!nodes_.empty()) {
+    start();
+  }
+}
+
+void
+ExecutorService::set_thread_count(size_t thread_count)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  thread_count_ = thread_count;
+}
+
+size_t
+ExecutorService::thread_count() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return thread_count_;
+}
+
+size_t
+ExecutorService::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return nodes_.size();
+}
+
+void
+ExecutorService::start()
+{
+  // A new executor each time, so that a change to the thread count is picked up. The
+  // default options are passed as {}, since their type differs between ROS2 distributions
+  // (executor::ExecutorArgs until Eloquent, ExecutorOptions since)
+  executor_.reset(new rclcpp::executors::MultiThreadedExecutor({}, thread_count_));
+  for (auto & node : nodes_) {
+    executor_->add_node(node);
+  }
+
+  // The executor's spin runs the calling thread as one of its threads, and starts the rest
+  std::promise<void> spin_done;
+  spin_done_ = spin_done.get_future();
+  thread_ = std::make_unique<std::thread>(
+    [executor = executor_.get(), spin_done = std::move(spin_done)]() mutable
+    {
+      executor->spin();
+      spin_done.set_value();
+    });
+}
+
+void
+ExecutorService::stop()
+{
+  if (thread_ == nullptr) {
+    return;
+  }
+
+  // A cancel that comes before the thread has started spinning is lost, so keep at it
+  // until the spin returns
+  do {
+    executor_->cancel();
+  } while (spin_done_.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready);
+
+  thread_->join();
+  thread_.reset();
+
+  for (auto & node : nodes_) {
+    executor_->remove_node(node);
+  }
+  executor_.reset();
+}
+
+}  // namespace ros2_behavior_tree
@@ -29,6 +29,7 @@
 #include "ros2_behavior_tree/control/pipeline_sequence_node.hpp"
 #include "ros2_behavior_tree/control/recovery_node.hpp"
 #include "ros2_behavior_tree/control/round_robin_node.hpp"
+#include "ros2_behavior_tree/decorator/deadline_node.hpp"
 #include "ros2_behavior_tree/decorator/distance_constraint_node.hpp"
 #include "ros2_behavior_tree/decorator/for_each_pose_node.hpp"
 #include "ros2_behavior_tree/decorator/forever_node.hpp"
@@ -55,6 +56,7 @@ NodeRegistrar::RegisterNodes(BT::BehaviorTreeFactory & factory)
   factory.registerNodeType<ros2_behavior_tree::ComputePathToPoseNode>("ComputePathToPose");
   factory.registerNodeType<ros2_behavior_tree::CreateROS2Node>("CreateROS2Node");
   factory.registerNodeType<ros2_behavior_tree::CreateTransformBufferNode>("CreateTransformBuffer");
+  factory.registerNodeType<ros2_behavior_tree::DeadlineNode>("Deadline");
   factory.registerNodeType<ros2_behavior_tree::DistanceConstraintNode>("DistanceConstraint");
   factory.registerNodeType<ros2_behavior_tree::FirstResultNode>("FirstResult");
   factory.registerNodeType<ros2_behavior_tree::FollowPathNode>("FollowPath");
@@ -0,0 +1,109 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/pending_cancels.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+namespace ros2_behavior_tree
+{
+
+// The PendingCancels of the tree being ticked on this thread
+static thread_local std::shared_ptr<PendingCancels> current_pending_cancels;
+
+uint64_t
+PendingCancels::add(std::chrono::milliseconds timeout)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t id = next_id_++;
+  deadlines_[id] = Clock::now() + timeout;
+  return id;
+}
+
+void
+PendingCancels::complete(uint64_t id)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    deadlines_.erase(id);
+  }
+  cv_.notify_all();
+}
+
+size_t
+PendingCancels::pending()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  remove_expired(Clock::now());
+  return deadlines_.size();
+}
+
+bool
+PendingCancels::wait_all(std::chrono::milliseconds timeout)
+{
+  auto deadline = Clock::now() + timeout;
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    auto now = Clock::now();
+    remove_expired(now);
+    if (deadlines_.empty()) {
+      return true;
+    }
+
+    if (now >= deadline) {
+      return false;
+    }
+
+    // Wake up for the earliest request deadline too, since that may leave nothing pending
+    auto wake_time = deadline;
+    for (const auto & entry : deadlines_) {
+      wake_time = std::min(wake_time, entry.second);
+    }
+    cv_.wait_until(lock, wake_time);
+  }
+}
+
+void
+PendingCancels::remove_expired(Clock::time_point now)
+{
+  for (auto it = deadlines_.begin(); it != deadlines_.end(); ) {
+    if (it->second <= now) {
+      it = deadlines_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+std::shared_ptr<PendingCancels>
+PendingCancels::current()
+{
+  return current_pending_cancels;
+}
+
+PendingCancels::Scope::Scope(std::shared_ptr<PendingCancels> pending_cancels)
+: previous_(std::move(current_pending_cancels))
+{
+  current_pending_cancels = std::move(pending_cancels);
+}
+
+PendingCancels::Scope::~Scope()
+{
+  current_pending_cancels = std::move(previous_);
+}
+
+}  // namespace ros2_behavior_tree
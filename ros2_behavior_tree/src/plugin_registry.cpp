@@ -0,0 +1,75 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/plugin_registry.hpp"
+
+#include <memory>
+#include <string>
+
+namespace ros2_behavior_tree
+{
+
+PluginRegistry &
+PluginRegistry::instance()
+{
+  static PluginRegistry registry;
+  return registry;
+}
+
+void
+PluginRegistry::register_nodes(
+  BT::BehaviorTreeFactory & factory, const std::string & library_name)
+{
+  auto manifest = get_manifest(library_name);
+
+  for (const auto & entry : *manifest) {
+    factory.registerBuilder(entry.manifest, entry.builder);
+  }
+}
+
+bool
+PluginRegistry::is_loaded(const std::string & library_name) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return manifests_.find(library_name) != manifests_.end();
+}
+
+std::shared_ptr<const PluginRegistry::PluginManifest>
+PluginRegistry::get_manifest(const std::string & library_name)
+{
+  // Hold the lock while loading so that concurrent first requests load the library once
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = manifests_.find(library_name);
+  if (it != manifests_.end()) {
+    return it->second;
+  }
+
+  // Let the plugin register its nodes with a scratch factory, then keep everything
+  // that isn't one of the factory's built-in nodes
+  BT::BehaviorTreeFactory loader;
+  loader.registerFromPlugin(std::string{"lib" + library_name + ".so"});
+
+  auto manifest = std::make_shared<PluginManifest>();
+  for (const auto & builder : loader.builders()) {
+    if (loader.builtinNodes().count(builder.first) == 0) {
+      manifest->push_back({loader.manifests().at(builder.first), builder.second});
+    }
+  }
+
+  manifests_[library_name] = manifest;
+  return manifest;
+}
+
+}  // namespace ros2_behavior_tree
@@ -0,0 +1,135 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/pooled_coro_action_node.hpp"
+
+#include <cassert>
+#include <string>
+
+namespace ros2_behavior_tree
+{
+
+PooledCoroActionNode::PooledCoroActionNode(
+  const std::string & name, const BT::NodeConfiguration & config)
+: BT::ActionNodeBase(name, config)
+{
+}
+
+PooledCoroActionNode::~PooledCoroActionNode()
+{
+  // By now the derived part of the node, whose tick() the coroutine is running, is gone,
+  // so the coroutine can't be unwound from here (see the class comment). If it is still
+  // active, reclaim the stack without resuming it; the coroutine's locals are leaked
+  assert(!active_ && "a PooledCoroActionNode must be halted before it is destroyed");
+  if (active_) {
+    finish();
+  }
+}
+
+void
+PooledCoroActionNode::setStatusRunningAndYield()
+{
+  setStatus(BT::NodeStatus::RUNNING);
+  caller_context_ = boost::context::detail::jump_fcontext(caller_context_, nullptr).fctx;
+
+  if (unwinding_) {
+    throw Unwind();
+  }
+}
+
+BT::NodeStatus
+PooledCoroActionNode::executeTick()
+{
+  if (!active_) {
+    stack_ = CoroutineStackPool::instance().acquire();
+
+    // The stack grows down from the end of the memory
+    coroutine_context_ = boost::context::detail::make_fcontext(
+      static_cast<char *>(stack_.base) + stack_.size, stack_.size,
+      &PooledCoroActionNode::run_coroutine);
+
+    active_ = true;
+    completed_ = false;
+  }
+
+  resume();
+
+  if (!completed_) {
+    return BT::NodeStatus::RUNNING;
+  }
+
+  finish();
+
+  if (exception_) {
+    std::exception_ptr exception;
+    std::swap(exception, exception_);
+    std::rethrow_exception(exception);
+  }
+
+  setStatus(result_);
+  return result_;
+}
+
+void
+PooledCoroActionNode::halt()
+{
+  if (!active_) {
+    return;
+  }
+
+  // Have the coroutine throw from where it yielded, so that its locals are destroyed
+  unwinding_ = true;
+  resume();
+  unwinding_ = false;
+
+  finish();
+  exception_ = nullptr;
+}
+
+void
+PooledCoroActionNode::run_coroutine(boost::context::detail::transfer_t transfer)
+{
+  // The first resume() passes the node
+  auto node = static_cast<PooledCoroActionNode *>(transfer.data);
+  node->caller_context_ = transfer.fctx;
+
+  try {
+    node->result_ = node->tick();
+  } catch (const Unwind &) {
+    node->result_ = BT::NodeStatus::IDLE;
+  } catch (...) {
+    node->exception_ = std::current_exception();
+  }
+
+  // The coroutine is never resumed after this, so its stack can be reused as soon as
+  // control is back on the tree's side
+  node->completed_ = true;
+  boost::context::detail::jump_fcontext(node->caller_context_, nullptr);
+}
+
+void
+PooledCoroActionNode::resume()
+{
+  coroutine_context_ = boost::context::detail::jump_fcontext(coroutine_context_, this).fctx;
+}
+
+void
+PooledCoroActionNode::finish()
+{
+  CoroutineStackPool::instance().release(stack_);
+  stack_ = CoroutineStackPool::Stack();
+  active_ = false;
+}
+
+}  // namespace ros2_behavior_tree
@@ -20,6 +20,7 @@
 
 #include <cmath>
 #include <memory>
+#include <string>
 
 #include "geometry_msgs/msg/twist.hpp"
 #include "visualization_msgs/msg/marker.hpp"
@@ -40,13 +41,40 @@ PurePursuitController::PurePursuitController(const std::string & name, const BT:
     throw BT::RuntimeError("Missing parameter [tf_buffer] in TransformPose node");
   }
 
-  path_sub_ = node_->create_subscription<nav_msgs::msg::Path>(path_topic_name_, queue_depth_, std::bind(
+  // Keep the subscriptions' callbacks off of the threads shared with everything else
+  // that the node handle does, if requested
+  bool subscription_thread = false;
+  getInput("subscription_thread", subscription_thread);
+
+  auto subscription_node = node_;
+  rclcpp::SubscriptionOptions subscription_options;
+  ThreadOptions thread_options;
+  if (subscription_thread) {
+    std::string cpus;
+    if (getInput("subscription_cpus", cpus)) {
+      thread_options.cpus = parse_cpu_list(cpus);
+    }
+    getInput("subscription_priority", thread_options.fifo_priority);
+
+    subscription_node_ = std::make_shared<rclcpp::Node>(
+      std::string(node_->get_name()) + "_pure_pursuit", node_->get_namespace());
+    subscription_group_ = subscription_node_->create_callback_group(
+      rclcpp::callback_group::CallbackGroupType::MutuallyExclusive);
+    subscription_options.callback_group = subscription_group_;
+    subscription_node = subscription_node_;
+  }
+
+  path_sub_ = subscription_node->create_subscription<nav_msgs::msg::Path>(path_topic_name_, queue_depth_, std::bind(
         &PurePursuitController::path_callback, this,
-        _1));
+        _1), subscription_options);
 
-  odom_sub_ = node_->create_subscription<nav_msgs::msg::Odometry>(odom_topic_name_, queue_depth_, std::bind(
+  odom_sub_ = subscription_node->create_subscription<nav_msgs::msg::Odometry>(odom_topic_name_, queue_depth_, std::bind(
         &PurePursuitController::odometry_callback, this,
-        _1));
+        _1), subscription_options);
+
+  if (subscription_thread) {
+    subscription_thread_ = std::make_unique<NodeThread>(subscription_node_, thread_options);
+  }
 
   cmd_vel_pub_ = node_->create_publisher<geometry_msgs::msg::Twist>(cmd_vel_topic_name_, queue_depth_);
 
@@ -81,19 +109,35 @@ PurePursuitController::get_current_pose() const
 void
 PurePursuitController::path_callback(const nav_msgs::msg::Path::SharedPtr msg)
 {
-  cur_ref_path_ = *msg;
-  next_waypoint_ = -1;
+  path_mailbox_.post(msg);
 }
 
 void
 PurePursuitController::odometry_callback(const nav_msgs::msg::Odometry::SharedPtr msg)
 {
-  current_velocity_ = msg->twist.twist;
+  odom_mailbox_.post(msg);
+}
+
+void
+PurePursuitController::take_latest_messages()
+{
+  if (auto path = path_mailbox_.take()) {
+    cur_ref_path_ = *path;
+    next_waypoint_ = -1;
+  }
+
+  if (auto odom = odom_mailbox_.take()) {
+    current_velocity_ = odom->twist.twist;
+  }
 }
 
 BT::NodeStatus
 PurePursuitController::tick()
 {
+  // The subscriptions' callbacks may run on another thread, so they hand the messages
+  // over rather than updating the controller's state
+  take_latest_messages();
+
   geometry_msgs::msg::Twist cmd_vel;
 
   if (step(cmd_vel)) {
@@ -0,0 +1,145 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/request_coalescer.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ros2_behavior_tree
+{
+
+RequestCoalescer &
+RequestCoalescer::instance()
+{
+  static RequestCoalescer coalescer;
+  return coalescer;
+}
+
+RequestCoalescer::~RequestCoalescer()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  batched_cv_.notify_one();
+
+  if (sender_.joinable()) {
+    sender_.join();
+  }
+}
+
+void
+RequestCoalescer::abandon(const std::shared_ptr<void> & call)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto shared_call = std::static_pointer_cast<Call>(call);
+  if (shared_call->waiters > 0 && --shared_call->waiters == 0) {
+    remove(shared_call);
+  }
+}
+
+uint64_t
+RequestCoalescer::requests() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return requests_;
+}
+
+uint64_t
+RequestCoalescer::round_trips() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return round_trips_;
+}
+
+uint64_t
+RequestCoalescer::coalesced() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return coalesced_;
+}
+
+void
+RequestCoalescer::remove(const std::shared_ptr<Call> & call)
+{
+  auto it = calls_.find(call->key);
+  if (it == calls_.end()) {
+    return;
+  }
+
+  auto & calls = it->second;
+  calls.erase(std::remove(calls.begin(), calls.end(), call), calls.end());
+  if (calls.empty()) {
+    calls_.erase(it);
+  }
+}
+
+std::vector<std::function<void()>>
+RequestCoalescer::complete(const std::shared_ptr<Call> & call)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  remove(call);
+  return std::move(call->callbacks);
+}
+
+void
+RequestCoalescer::schedule(const std::shared_ptr<Call> & call, Clock::time_point when)
+{
+  if (!sender_.joinable()) {
+    sender_ = std::thread(&RequestCoalescer::send_batched, this);
+  }
+
+  batched_.emplace(when, call);
+  batched_cv_.notify_one();
+}
+
+void
+RequestCoalescer::send_batched()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (!stopping_) {
+    if (batched_.empty()) {
+      batched_cv_.wait(lock);
+      continue;
+    }
+
+    auto when = batched_.begin()->first;
+    if (Clock::now() < when) {
+      batched_cv_.wait_until(lock, when);
+      continue;
+    }
+
+    auto call = batched_.begin()->second;
+    batched_.erase(batched_.begin());
+
+    // Don't bother if the callers have all given up on it (see abandon)
+    auto it = calls_.find(call->key);
+    if (it == calls_.end() ||
+      std::find(it->second.begin(), it->second.end(), call) == it->second.end())
+    {
+      continue;
+    }
+
+    // Send without the lock, as the response may arrive right away
+    lock.unlock();
+    call->send();
+    lock.lock();
+  }
+}
+
+}  // namespace ros2_behavior_tree
@@ -0,0 +1,116 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/response_cache.hpp"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace ros2_behavior_tree
+{
+
+ResponseCache &
+ResponseCache::instance()
+{
+  static ResponseCache cache;
+  return cache;
+}
+
+void
+ResponseCache::set_capacity(size_t capacity)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_ = capacity;
+  trim();
+}
+
+size_t
+ResponseCache::capacity() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return capacity_;
+}
+
+void
+ResponseCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+}
+
+ResponseCache::Statistics
+ResponseCache::statistics() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  Statistics statistics = statistics_;
+  statistics.size = entries_.size();
+  return statistics;
+}
+
+std::shared_ptr<const void>
+ResponseCache::lookup(const std::string & key)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    statistics_.misses++;
+    return nullptr;
+  }
+
+  if (Clock::now() >= it->second->expires) {
+    statistics_.misses++;
+    statistics_.expirations++;
+    entries_.erase(it->second);
+    index_.erase(it);
+    return nullptr;
+  }
+
+  // Move the entry to the front, as the most recently used
+  entries_.splice(entries_.begin(), entries_, it->second);
+  statistics_.hits++;
+  return entries_.front().response;
+}
+
+void
+ResponseCache::store(
+  const std::string & key, std::shared_ptr<const void> response,
+  std::chrono::milliseconds ttl)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+
+  entries_.push_front(Entry{key, std::move(response), Clock::now() + ttl});
+  index_[key] = entries_.begin();
+  trim();
+}
+
+void
+ResponseCache::trim()
+{
+  while (entries_.size() > capacity_) {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+    statistics_.evictions++;
+  }
+}
+
+}  // namespace ros2_behavior_tree
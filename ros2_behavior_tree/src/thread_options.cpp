@@ -0,0 +1,115 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/thread_options.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "behaviortree_cpp_v3/exceptions.h"
+#include "rclcpp/rclcpp.hpp"
+
+namespace ros2_behavior_tree
+{
+
+std::vector<int>
+parse_cpu_list(const std::string & list)
+{
+  std::vector<int> cpus;
+
+  size_t start = 0;
+  while (start < list.size()) {
+    size_t end = list.find(',', start);
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+    std::string item = list.substr(start, end - start);
+    start = end + 1;
+
+    try {
+      size_t dash = item.find('-');
+      int first = std::stoi(item.substr(0, dash));
+      int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+      if (first < 0 || last < first || last >= CPU_SETSIZE) {
+        throw std::out_of_range(item);
+      }
+      for (int cpu = first; cpu <= last; cpu++) {
+        cpus.push_back(cpu);
+      }
+    } catch (const std::logic_error &) {
+      throw BT::RuntimeError("Invalid CPU list: \"" + list + "\"");
+    }
+  }
+
+  return cpus;
+}
+
+bool
+apply_thread_options(const ThreadOptions & options)
+{
+  auto logger = rclcpp::get_logger("ThreadOptions");
+  bool applied = true;
+
+  if (!options.cpus.empty()) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int cpu : options.cpus) {
+      CPU_SET(cpu, &cpu_set);
+    }
+
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (rc != 0) {
+      RCLCPP_WARN(logger, "Couldn't set the thread's CPU affinity: %s", strerror(rc));
+      applied = false;
+    }
+  }
+
+  bool fifo = false;
+  if (options.fifo_priority > 0) {
+    sched_param param{};
+    param.sched_priority = options.fifo_priority;
+
+    int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (rc == 0) {
+      fifo = true;
+    } else {
+      RCLCPP_WARN(logger, "Couldn't run the thread with SCHED_FIFO priority %d: %s",
+        options.fifo_priority, strerror(rc));
+      applied = false;
+    }
+  }
+
+  // On Linux, the nice value of a thread is set through its thread ID
+  if (!fifo && options.nice != 0) {
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(tid), options.nice) != 0) {
+      RCLCPP_WARN(logger, "Couldn't set the thread's nice value to %d: %s",
+        options.nice, strerror(errno));
+      applied = false;
+    }
+  }
+
+  return applied;
+}
+
+}  // namespace ros2_behavior_tree
@@ -0,0 +1,61 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/tick_deadline.hpp"
+
+#include <algorithm>
+
+namespace ros2_behavior_tree
+{
+
+// The deadline of the part of the tree being ticked on this thread
+static thread_local TickDeadline::Clock::time_point current_deadline =
+  TickDeadline::Clock::time_point::max();
+
+TickDeadline::Clock::time_point
+TickDeadline::current()
+{
+  return current_deadline;
+}
+
+bool
+TickDeadline::expired()
+{
+  return current_deadline != Clock::time_point::max() && Clock::now() >= current_deadline;
+}
+
+std::chrono::milliseconds
+TickDeadline::clamp(std::chrono::milliseconds timeout)
+{
+  if (current_deadline == Clock::time_point::max()) {
+    return timeout;
+  }
+
+  auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+    current_deadline - Clock::now());
+  return std::max(std::chrono::milliseconds(0), std::min(timeout, remaining));
+}
+
+TickDeadline::Scope::Scope(Clock::time_point deadline)
+: previous_(current_deadline)
+{
+  current_deadline = std::min(previous_, deadline);
+}
+
+TickDeadline::Scope::~Scope()
+{
+  current_deadline = previous_;
+}
+
+}  // namespace ros2_behavior_tree
@@ -0,0 +1,282 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/tick_profiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "behaviortree_cpp_v3/control_node.h"
+#include "behaviortree_cpp_v3/decorator_node.h"
+
+namespace ros2_behavior_tree
+{
+
+namespace
+{
+
+// The profiler swaps the child pointers held by the control and decorator nodes, which
+// BT.CPP keeps protected. These give access to them through pointers to members
+struct ControlNodeAccess : public BT::ControlNode
+{
+  static std::vector<BT::TreeNode *> & children(BT::ControlNode & node)
+  {
+    return node.*(&ControlNodeAccess::children_nodes_);
+  }
+};
+
+struct DecoratorNodeAccess : public BT::DecoratorNode
+{
+  static BT::TreeNode * & child(BT::DecoratorNode & node)
+  {
+    return node.*(&DecoratorNodeAccess::child_node_);
+  }
+};
+
+// Node names end up in the folded stack output, where ';' and ' ' are separators
+std::string
+sanitize(const std::string & name)
+{
+  std::string result = name;
+  std::replace(result.begin(), result.end(), ';', '_');
+  std::replace(result.begin(), result.end(), ' ', '_');
+  return result;
+}
+
+std::string
+display_name(const BT::TreeNode * node)
+{
+  return node->name().empty() ? node->registrationName() : node->name();
+}
+
+}  // namespace
+
+// The wrapper that sits between a node and its parent while the tree is instrumented
+class ProfiledTickNode : public BT::DecoratorNode
+{
+public:
+  ProfiledTickNode(TickProfiler & profiler, size_t index, BT::TreeNode * node)
+  : BT::DecoratorNode(node->name(), {}), profiler_(profiler), index_(index)
+  {
+    DecoratorNodeAccess::child(*this) = node;
+  }
+
+protected:
+  BT::NodeStatus tick() override
+  {
+    // When a parent is done with a child, it sets the child (this wrapper) back to IDLE.
+    // Do the same for the wrapped node, since some nodes rely on it to start over
+    if (status() == BT::NodeStatus::IDLE && child_node_->status() != BT::NodeStatus::RUNNING) {
+      child_node_->setStatus(BT::NodeStatus::IDLE);
+    }
+
+    return profiler_.timed_tick(index_, child_node_);
+  }
+
+  TickProfiler & profiler_;
+  size_t index_;
+};
+
+TickProfiler::TickProfiler(BT::Tree & tree)
+: root_(tree.root_node)
+{
+  add_profile(root_, "");
+  add_children(root_, profiles_[0].path);
+
+  // Make sure that ticking doesn't allocate
+  child_time_stack_.reserve(profiles_.size() + 1);
+}
+
+TickProfiler::~TickProfiler()
+{
+  restore();
+}
+
+size_t
+TickProfiler::add_profile(BT::TreeNode * node, const std::string & parent_path)
+{
+  NodeProfile profile;
+  profile.uid = node->UID();
+  profile.name = display_name(node);
+  profile.path = parent_path.empty() ?
+    sanitize(profile.name) : parent_path + ";" + sanitize(profile.name);
+
+  profiles_.push_back(profile);
+  return profiles_.size() - 1;
+}
+
+void
+TickProfiler::add_children(BT::TreeNode * node, const std::string & path)
+{
+  std::vector<BT::TreeNode *> children;
+  if (auto control = dynamic_cast<BT::ControlNode *>(node)) {
+    children = ControlNodeAccess::children(*control);
+  } else if (auto decorator = dynamic_cast<BT::DecoratorNode *>(node)) {
+    children.push_back(DecoratorNodeAccess::child(*decorator));
+  }
+
+  for (size_t i = 0; i < children.size(); i++) {
+    size_t index = add_profile(children[i], path);
+    wrappers_.push_back(
+      {node, i, children[i], std::make_unique<ProfiledTickNode>(*this, index, children[i])});
+
+    // Copy the path, since adding more profiles may reallocate the vector
+    std::string child_path = profiles_[index].path;
+    add_children(children[i], child_path);
+  }
+}
+
+void
+TickProfiler::instrument()
+{
+  if (instrumented_) {
+    return;
+  }
+
+  for (auto & wrapper : wrappers_) {
+    wrapper.node->setStatus(wrapper.target->status());
+
+    if (auto control = dynamic_cast<BT::ControlNode *>(wrapper.parent)) {
+      ControlNodeAccess::children(*control)[wrapper.child_index] = wrapper.node.get();
+    } else if (auto decorator = dynamic_cast<BT::DecoratorNode *>(wrapper.parent)) {
+      DecoratorNodeAccess::child(*decorator) = wrapper.node.get();
+    }
+  }
+
+  instrumented_ = true;
+}
+
+void
+TickProfiler::restore()
+{
+  if (!instrumented_) {
+    return;
+  }
+
+  for (auto & wrapper : wrappers_) {
+    if (auto control = dynamic_cast<BT::ControlNode *>(wrapper.parent)) {
+      ControlNodeAccess::children(*control)[wrapper.child_index] = wrapper.target;
+    } else if (auto decorator = dynamic_cast<BT::DecoratorNode *>(wrapper.parent)) {
+      DecoratorNodeAccess::child(*decorator) = wrapper.target;
+    }
+  }
+
+  instrumented_ = false;
+}
+
+BT::NodeStatus
+TickProfiler::tick_root()
+{
+  return timed_tick(0, root_);
+}
+
+BT::NodeStatus
+TickProfiler::timed_tick(size_t index, BT::TreeNode * node)
+{
+  auto start = Clock::now();
+  child_time_stack_.push_back(Clock::duration::zero());
+
+  BT::NodeStatus status;
+  try {
+    status = node->executeTick();
+  } catch (...) {
+    child_time_stack_.pop_back();
+    throw;
+  }
+
+  auto elapsed = Clock::now() - start;
+  auto child_time = child_time_stack_.back();
+  child_time_stack_.pop_back();
+
+  // Charge this node's time to its parent's children
+  if (!child_time_stack_.empty()) {
+    child_time_stack_.back() += elapsed;
+  }
+
+  auto & profile = profiles_[index];
+  profile.calls++;
+  profile.total_time += elapsed;
+  profile.self_time += elapsed - child_time;
+
+  switch (status) {
+    case BT::NodeStatus::RUNNING:
+      profile.running++;
+      break;
+
+    case BT::NodeStatus::SUCCESS:
+      profile.success++;
+      break;
+
+    case BT::NodeStatus::FAILURE:
+      profile.failure++;
+      break;
+
+    default:
+      break;
+  }
+
+  return status;
+}
+
+void
+TickProfiler::clear()
+{
+  for (auto & profile : profiles_) {
+    profile.calls = 0;
+    profile.total_time = Clock::duration::zero();
+    profile.self_time = Clock::duration::zero();
+    profile.running = 0;
+    profile.success = 0;
+    profile.failure = 0;
+  }
+}
+
+void
+TickProfiler::write_table(std::ostream & os) const
+{
+  auto msec = [](Clock::duration d) {
+      return std::chrono::duration<double, std::milli>(d).count();
+    };
+
+  char line[256];
+  snprintf(line, sizeof(line), "%6s %10s %12s %12s %12s %10s %10s %10s  %s\n",
+    "uid", "calls", "total(ms)", "self(ms)", "avg(us)", "running", "success", "failure", "node");
+  os << line;
+
+  for (const auto & profile : profiles_) {
+    double avg_usec = profile.calls ? 1000.0 * msec(profile.total_time) / profile.calls : 0.0;
+    snprintf(line, sizeof(line), "%6u %10lu %12.3f %12.3f %12.3f %10lu %10lu %10lu  ",
+      static_cast<unsigned>(profile.uid), static_cast<unsigned long>(profile.calls),
+      msec(profile.total_time), msec(profile.self_time), avg_usec,
+      static_cast<unsigned long>(profile.running), static_cast<unsigned long>(profile.success),
+      static_cast<unsigned long>(profile.failure));
+    os << line << profile.name << "\n";
+  }
+}
+
+void
+TickProfiler::write_folded(std::ostream & os) const
+{
+  for (const auto & profile : profiles_) {
+    auto usec = std::chrono::duration_cast<std::chrono::microseconds>(profile.self_time).count();
+    if (usec > 0) {
+      os << profile.path << " " << usec << "\n";
+    }
+  }
+}
+
+}  // namespace ros2_behavior_tree
@@ -0,0 +1,111 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/tick_wakeup.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+namespace ros2_behavior_tree
+{
+
+// The wakeup of the tree being ticked on this thread
+static thread_local std::shared_ptr<TickWakeup> current_wakeup;
+
+void
+TickWakeup::notify()
+{
+  Listener listener;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_ = true;
+    listener = listener_;
+  }
+  cv_.notify_all();
+
+  if (listener) {
+    listener(Clock::now());
+  }
+}
+
+void
+TickWakeup::notify_at(Clock::time_point when)
+{
+  Listener listener;
+  bool earlier = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (when < requested_) {
+      requested_ = when;
+      earlier = true;
+    }
+    listener = listener_;
+  }
+
+  // Let a waiting tick loop recompute how long to sleep
+  if (earlier) {
+    cv_.notify_all();
+  }
+
+  // The listener keeps track of its own schedule, so it hears about every request
+  if (listener) {
+    listener(when);
+  }
+}
+
+void
+TickWakeup::set_listener(Listener listener)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  listener_ = std::move(listener);
+}
+
+bool
+TickWakeup::wait_until(Clock::time_point deadline)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (!pending_) {
+    auto wake_time = std::min(deadline, requested_);
+    if (Clock::now() >= wake_time) {
+      break;
+    }
+    cv_.wait_until(lock, wake_time);
+  }
+
+  bool notified = pending_;
+  pending_ = false;
+  requested_ = Clock::time_point::max();
+  return notified;
+}
+
+std::shared_ptr<TickWakeup>
+TickWakeup::current()
+{
+  return current_wakeup;
+}
+
+TickWakeup::Scope::Scope(std::shared_ptr<TickWakeup> wakeup)
+: previous_(std::move(current_wakeup))
+{
+  current_wakeup = std::move(wakeup);
+}
+
+TickWakeup::Scope::~Scope()
+{
+  current_wakeup = std::move(previous_);
+}
+
+}  // namespace ros2_behavior_tree
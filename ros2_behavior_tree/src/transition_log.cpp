@@ -0,0 +1,299 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ros2_behavior_tree/transition_log.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "behaviortree_cpp_v3/exceptions.h"
+
+namespace ros2_behavior_tree
+{
+
+constexpr uint8_t TransitionRecord::node_name;
+constexpr char TransitionLogHeader::magic_value[8];
+constexpr uint32_t TransitionLogHeader::current_version;
+
+namespace
+{
+
+// The file grows in steps of at least this many bytes, to limit how often it is remapped
+constexpr size_t min_file_growth = 1 << 20;
+
+// The number of records moved from the ring to the file at a time
+constexpr size_t drain_batch_size = 256;
+
+}  // namespace
+
+TransitionLogWriter::TransitionLogWriter(
+  const std::string & filename,
+  size_t ring_capacity,
+  std::chrono::milliseconds drain_period)
+: filename_(filename), drain_period_(drain_period), ring_(ring_capacity)
+{
+  fd_ = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) {
+    throw BT::RuntimeError(
+            "TransitionLogWriter: could not open " + filename + ": " + std::strerror(errno));
+  }
+
+  TransitionLogHeader header{};
+  std::memcpy(header.magic, TransitionLogHeader::magic_value, sizeof(header.magic));
+  header.version = TransitionLogHeader::current_version;
+  header.record_size = sizeof(TransitionRecord);
+
+  try {
+    append(&header, sizeof(header));
+  } catch (...) {
+    ::close(fd_);
+    throw;
+  }
+
+  thread_ = std::thread(&TransitionLogWriter::run, this);
+}
+
+TransitionLogWriter::~TransitionLogWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+
+  // Trim the file to the data actually written
+  if (map_ != nullptr) {
+    ::munmap(map_, map_size_);
+  }
+  if (::ftruncate(fd_, offset_) != 0) {
+    // Nothing useful to do from a destructor; the reader relies on record_count anyway
+  }
+  ::close(fd_);
+}
+
+void
+TransitionLogWriter::add_node_name(uint16_t uid, const std::string & name)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (named_uids_.insert(uid).second) {
+    pending_names_.emplace_back(uid, name);
+  }
+}
+
+void
+TransitionLogWriter::flush()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  uint64_t ticket = ++flush_requests_;
+  wake_.notify_one();
+  flushed_.wait(lock, [this, ticket] {return flushes_done_ >= ticket;});
+}
+
+void
+TransitionLogWriter::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;; ) {
+    bool stopping = stopping_;
+    uint64_t flush_requests = flush_requests_;
+    lock.unlock();
+
+    if (!failed_) {
+      try {
+        write_pending();
+        if (flush_requests != flushes_done_) {
+          ::msync(map_, offset_, MS_ASYNC);
+        }
+      } catch (const BT::RuntimeError &) {
+        // Typically out of disk space. Stop writing, but keep draining the ring so that
+        // the loss shows up in dropped()
+        failed_ = true;
+      }
+    }
+    if (failed_) {
+      discard_pending();
+    }
+
+    lock.lock();
+    if (flush_requests != flushes_done_) {
+      flushes_done_ = flush_requests;
+      flushed_.notify_all();
+    }
+
+    if (stopping) {
+      break;
+    }
+
+    wake_.wait_for(lock, drain_period_,
+      [this, flush_requests] {return stopping_ || flush_requests_ != flush_requests;});
+  }
+}
+
+void
+TransitionLogWriter::write_pending()
+{
+  std::vector<std::pair<uint16_t, std::string>> names;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    names.swap(pending_names_);
+  }
+
+  uint64_t records = 0;
+  for (const auto & name : names) {
+    TransitionRecord record{};
+    record.uid = name.first;
+    record.status = TransitionRecord::node_name;
+    record.extra = static_cast<uint32_t>(name.second.size());
+    append(&record, sizeof(record));
+
+    // Pad the name out to a whole number of records
+    size_t blocks = (name.second.size() + sizeof(record) - 1) / sizeof(record);
+    std::vector<char> padded(blocks * sizeof(record), '\0');
+    std::copy(name.second.begin(), name.second.end(), padded.begin());
+    append(padded.data(), padded.size());
+
+    records += 1 + blocks;
+  }
+
+  TransitionRecord batch[drain_batch_size];
+  size_t count;
+  while ((count = ring_.pop(batch, drain_batch_size)) > 0) {
+    append(batch, count * sizeof(TransitionRecord));
+    records += count;
+  }
+
+  if (records > 0) {
+    auto header = reinterpret_cast<TransitionLogHeader *>(map_);
+    header->record_count += records;
+    header->dropped = dropped_.load(std::memory_order_relaxed);
+  }
+}
+
+void
+TransitionLogWriter::discard_pending()
+{
+  TransitionRecord batch[drain_batch_size];
+  size_t count;
+  while ((count = ring_.pop(batch, drain_batch_size)) > 0) {
+    dropped_.fetch_add(count, std::memory_order_relaxed);
+  }
+}
+
+void
+TransitionLogWriter::append(const void * data, size_t size)
+{
+  reserve(offset_ + size);
+  std::memcpy(map_ + offset_, data, size);
+  offset_ += size;
+}
+
+void
+TransitionLogWriter::reserve(size_t size)
+{
+  if (size <= map_size_) {
+    return;
+  }
+
+  size_t new_size = std::max(size, map_size_ + std::max(map_size_, min_file_growth));
+
+  if (map_ != nullptr) {
+    ::munmap(map_, map_size_);
+    map_ = nullptr;
+  }
+
+  if (::ftruncate(fd_, new_size) != 0) {
+    throw BT::RuntimeError(
+            "TransitionLogWriter: could not grow " + filename_ + ": " + std::strerror(errno));
+  }
+
+  void * map = ::mmap(nullptr, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (map == MAP_FAILED) {
+    throw BT::RuntimeError(
+            "TransitionLogWriter: could not map " + filename_ + ": " + std::strerror(errno));
+  }
+
+  map_ = static_cast<char *>(map);
+  map_size_ = new_size;
+}
+
+TransitionLog
+read_transition_log(const std::string & filename)
+{
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw BT::RuntimeError("Could not open " + filename + ": " + std::strerror(errno));
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TransitionLogHeader)) {
+    ::close(fd);
+    throw BT::RuntimeError(filename + " is not a transition log");
+  }
+
+  size_t size = st.st_size;
+  void * map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    throw BT::RuntimeError("Could not map " + filename + ": " + std::strerror(errno));
+  }
+
+  TransitionLog log;
+  std::memcpy(&log.header, map, sizeof(log.header));
+
+  if (std::memcmp(log.header.magic, TransitionLogHeader::magic_value,
+    sizeof(log.header.magic)) != 0 ||
+    log.header.version != TransitionLogHeader::current_version ||
+    log.header.record_size != sizeof(TransitionRecord))
+  {
+    ::munmap(map, size);
+    throw BT::RuntimeError(filename + " is not a supported transition log");
+  }
+
+  // A log that is still being written may be shorter than the header claims
+  const char * data = static_cast<const char *>(map) + sizeof(TransitionLogHeader);
+  uint64_t available = (size - sizeof(TransitionLogHeader)) / sizeof(TransitionRecord);
+  uint64_t count = std::min(log.header.record_count, available);
+
+  for (uint64_t i = 0; i < count; i++) {
+    TransitionRecord record;
+    std::memcpy(&record, data + i * sizeof(record), sizeof(record));
+
+    if (record.status != TransitionRecord::node_name) {
+      log.transitions.push_back(record);
+      continue;
+    }
+
+    uint64_t blocks = (record.extra + sizeof(record) - 1) / sizeof(record);
+    if (i + blocks >= count) {
+      break;
+    }
+    log.node_names[record.uid] = std::string(data + (i + 1) * sizeof(record), record.extra);
+    i += blocks;
+  }
+
+  ::munmap(map, size);
+  return log;
+}
+
+}  // namespace ros2_behavior_tree
@@ -25,6 +25,10 @@ class TestNodeRegistrar
 {
 public:
   static void RegisterNodes(BT::BehaviorTreeFactory & factory);
+
+  // The number of times the nodes have been registered, which is once each time the
+  // plugin's registration function is run
+  static int registrations();
 };
 
 }  // namespace ros2_behavior_tree
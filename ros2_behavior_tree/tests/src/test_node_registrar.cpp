@@ -15,6 +15,8 @@
 
 #include "test_node_registrar.hpp"
 
+#include <atomic>
+
 #include "ros2_behavior_tree/node_registrar.hpp"
 #include "add_two_ints_client.hpp"
 #include "fibonacci_client.hpp"
@@ -27,11 +29,20 @@ BT_REGISTER_NODES(factory)
 namespace ros2_behavior_tree
 {
 
+static std::atomic<int> registration_count{0};
+
 void
 TestNodeRegistrar::RegisterNodes(BT::BehaviorTreeFactory & factory)
 {
   factory.registerNodeType<AddTwoIntsClient>("AddTwoInts");
   factory.registerNodeType<FibonacciClient>("Fibonacci");
+  registration_count++;
+}
+
+int
+TestNodeRegistrar::registrations()
+{
+  return registration_count;
 }
 
 }  // namespace ros2_behavior_tree
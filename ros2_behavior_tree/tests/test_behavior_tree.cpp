@@ -0,0 +1,465 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "geometry_msgs/msg/pose_stamped.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "ros2_behavior_tree/behavior_tree.hpp"
+#include "ros2_behavior_tree/behavior_tree_executor.hpp"
+#include "ros2_behavior_tree/behavior_tree_pool.hpp"
+#include "ros2_behavior_tree/compiled_tree.hpp"
+#include "ros2_behavior_tree/tick_wakeup.hpp"
+#include "ros2_behavior_tree/transition_log.hpp"
+
+static const char * xml_text =
+  R"(
+ <root main_tree_to_execute = "MainTree" >
+     <BehaviorTree ID="MainTree">
+        <Sequence name="root">
+            <Recovery num_retries="1">
+              <AlwaysSuccess/>
+              <AlwaysFailure/>
+            </Recovery>
+            <AlwaysSuccess/>
+        </Sequence>
+     </BehaviorTree>
+ </root>
+ )";
+
+// A tree that runs until it is halted
+static const char * forever_xml_text =
+  R"(
+ <root main_tree_to_execute = "MainTree" >
+     <BehaviorTree ID="MainTree">
+        <Forever>
+            <AlwaysSuccess/>
+        </Forever>
+     </BehaviorTree>
+ </root>
+ )";
+
+// A prepared tree should be able to be executed repeatedly with the same result
+TEST(TestBehaviorTree, ReuseTree)
+{
+  ros2_behavior_tree::BehaviorTree bt(xml_text);
+  bt.prepare();
+
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(bt.execute(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+  }
+}
+
+// When reuse is disabled, the tree is re-created on each call to execute
+TEST(TestBehaviorTree, NoReuseTree)
+{
+  ros2_behavior_tree::BehaviorTree bt(xml_text);
+  bt.set_reuse_tree(false);
+
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(bt.execute(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+  }
+}
+
+// A tree that was halted while running should start over from the beginning on the next
+// execution, rather than resume where it was halted
+TEST(TestBehaviorTree, ExecuteAfterHalt)
+{
+  static const char * wait_xml_text =
+    R"(
+ <root main_tree_to_execute = "MainTree" >
+     <BehaviorTree ID="MainTree">
+        <Sequence>
+            <SetBlackboard output_key="started" value="yes"/>
+            <RepeatUntil key="done" value="true">
+                <AlwaysSuccess/>
+            </RepeatUntil>
+            <SetBlackboard output_key="finished" value="yes"/>
+        </Sequence>
+     </BehaviorTree>
+ </root>
+ )";
+
+  ros2_behavior_tree::BehaviorTree bt(wait_xml_text);
+  bt.set_console_logging(false);
+  auto blackboard = bt.blackboard();
+  std::string value;
+
+  // Halt after the first tick, with the tree waiting on RepeatUntil
+  int ticks = 0;
+  ASSERT_EQ(bt.execute([&ticks]() {return ticks++ > 0;}), ros2_behavior_tree::BtStatus::HALTED);
+  ASSERT_TRUE(blackboard->get("started", value));
+  ASSERT_EQ(value, "yes");
+  ASSERT_FALSE(blackboard->get("finished", value));
+
+  // Executing again runs the Sequence from its first child
+  blackboard->set<std::string>("started", "no");
+  blackboard->set<bool>("done", true);
+  ASSERT_EQ(bt.execute(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+  ASSERT_TRUE(blackboard->get("started", value));
+  ASSERT_EQ(value, "yes");
+  ASSERT_TRUE(blackboard->get("finished", value));
+  ASSERT_EQ(value, "yes");
+}
+
+// Trees released by their users should be returned to the pool
+TEST(TestBehaviorTree, PoolReturnsTrees)
+{
+  ros2_behavior_tree::BehaviorTreePool pool(xml_text);
+  ASSERT_EQ(pool.available(), 0u);
+
+  {
+    auto bt1 = pool.acquire();
+    auto bt2 = pool.acquire();
+    ASSERT_NE(bt1, bt2);
+    ASSERT_EQ(bt1->execute(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+  }
+
+  ASSERT_EQ(pool.available(), 2u);
+
+  auto bt = pool.acquire();
+  ASSERT_EQ(pool.available(), 1u);
+  ASSERT_EQ(bt->execute(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+}
+
+// A tree returned to the pool should have its nodes' outputs emptied, but keep its inputs
+TEST(TestBehaviorTree, PoolClearsOutputs)
+{
+  static const char * for_each_pose_xml_text =
+    R"(
+ <root main_tree_to_execute = "MainTree" >
+     <BehaviorTree ID="MainTree">
+        <ForEachPose poses="{poses}" pose="{pose}">
+            <AlwaysSuccess/>
+        </ForEachPose>
+     </BehaviorTree>
+ </root>
+ )";
+
+  ros2_behavior_tree::BehaviorTreePool pool(for_each_pose_xml_text);
+  BT::Blackboard::Ptr blackboard;
+
+  {
+    auto bt = pool.acquire();
+    bt->set_console_logging(false);
+    blackboard = bt->blackboard();
+    blackboard->set("poses", std::vector<geometry_msgs::msg::PoseStamped>(1));
+    ASSERT_EQ(bt->execute(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+    ASSERT_FALSE(blackboard->getAny("pose")->empty());
+  }
+
+  auto bt = pool.acquire();
+  ASSERT_EQ(bt->blackboard(), blackboard);
+  ASSERT_TRUE(blackboard->getAny("pose")->empty());
+  ASSERT_FALSE(blackboard->getAny("poses")->empty());
+
+  // The tree writes its outputs again when it's executed
+  ASSERT_EQ(bt->execute(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+  ASSERT_FALSE(blackboard->getAny("pose")->empty());
+}
+
+// A notification from another thread should end the wait before the deadline
+TEST(TestBehaviorTree, WakeupNotify)
+{
+  using ros2_behavior_tree::TickWakeup;
+  TickWakeup wakeup;
+
+  auto start = TickWakeup::Clock::now();
+  std::thread notifier([&wakeup]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      wakeup.notify();
+    });
+
+  ASSERT_TRUE(wakeup.wait_until(start + std::chrono::seconds(5)));
+  ASSERT_LT(TickWakeup::Clock::now() - start, std::chrono::seconds(5));
+  notifier.join();
+
+  // The notification has been consumed, so the next wait runs to the deadline
+  ASSERT_FALSE(wakeup.wait_until(TickWakeup::Clock::now() + std::chrono::milliseconds(10)));
+}
+
+// A requested tick time earlier than the deadline should end the wait at that time
+TEST(TestBehaviorTree, WakeupNotifyAt)
+{
+  using ros2_behavior_tree::TickWakeup;
+  TickWakeup wakeup;
+
+  auto start = TickWakeup::Clock::now();
+  wakeup.notify_at(start + std::chrono::milliseconds(20));
+
+  ASSERT_FALSE(wakeup.wait_until(start + std::chrono::seconds(5)));
+  auto elapsed = TickWakeup::Clock::now() - start;
+  ASSERT_GE(elapsed, std::chrono::milliseconds(20));
+  ASSERT_LT(elapsed, std::chrono::seconds(5));
+}
+
+// The current wakeup is only set within a scope
+TEST(TestBehaviorTree, WakeupScope)
+{
+  using ros2_behavior_tree::TickWakeup;
+  auto wakeup = std::make_shared<TickWakeup>();
+
+  ASSERT_EQ(TickWakeup::current(), nullptr);
+  {
+    TickWakeup::Scope scope(wakeup);
+    ASSERT_EQ(TickWakeup::current(), wakeup);
+  }
+  ASSERT_EQ(TickWakeup::current(), nullptr);
+}
+
+// Ticking on events should give the same results as ticking periodically
+TEST(TestBehaviorTree, WakeOnEvent)
+{
+  ros2_behavior_tree::BehaviorTree bt(xml_text);
+  bt.set_wake_on_event(true);
+
+  ASSERT_EQ(bt.execute(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+}
+
+// Each tick of the tree should be recorded in the tick statistics
+TEST(TestBehaviorTree, TickStatistics)
+{
+  ros2_behavior_tree::BehaviorTree bt(xml_text);
+  ASSERT_EQ(bt.tick_statistics().ticks.load(), 0u);
+
+  ASSERT_EQ(bt.execute(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+  ASSERT_EQ(bt.execute(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+
+  // The tree completes in a single tick
+  ASSERT_EQ(bt.tick_statistics().ticks.load(), 2u);
+  ASSERT_EQ(bt.tick_statistics().tick_duration.count(), 2u);
+  ASSERT_GE(bt.tick_statistics().tick_duration.max(),
+    bt.tick_statistics().tick_duration.percentile(0.5));
+
+  bt.reset_tick_statistics();
+  ASSERT_EQ(bt.tick_statistics().ticks.load(), 0u);
+}
+
+// With profiling enabled, every node in the tree should show up in the profile
+TEST(TestBehaviorTree, Profiling)
+{
+  ros2_behavior_tree::BehaviorTree bt(xml_text);
+  bt.set_profiling(true);
+
+  ASSERT_EQ(bt.execute(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+  ASSERT_EQ(bt.execute(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+
+  std::ostringstream table;
+  bt.write_profile(table);
+  ASSERT_NE(table.str().find("Recovery"), std::string::npos);
+  ASSERT_NE(table.str().find("AlwaysFailure"), std::string::npos);
+
+  // Nodes that completed in under a microsecond are left out of the folded stacks, so
+  // only check that every line has the "path count" form
+  std::ostringstream folded;
+  bt.write_profile_folded(folded);
+  std::istringstream lines(folded.str());
+  for (std::string line; std::getline(lines, line); ) {
+    ASSERT_EQ(line.find("root"), 0u);
+    ASSERT_NE(line.rfind(' '), std::string::npos);
+  }
+}
+
+// The status changes of the nodes should be recorded to the transition log
+TEST(TestBehaviorTree, TransitionLog)
+{
+  std::string filename = "/tmp/test_behavior_tree_transitions.bin";
+  {
+    ros2_behavior_tree::BehaviorTree bt(xml_text);
+    bt.set_console_logging(false);
+    bt.set_transition_log(filename);
+
+    ASSERT_EQ(bt.execute(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+    bt.transition_log()->flush();
+  }
+
+  auto log = ros2_behavior_tree::read_transition_log(filename);
+  std::remove(filename.c_str());
+
+  ASSERT_EQ(log.header.dropped, 0u);
+  ASSERT_FALSE(log.transitions.empty());
+
+  // Each node that changed status should have been named
+  bool found_recovery = false;
+  for (const auto & transition : log.transitions) {
+    ASSERT_NE(log.node_names.find(transition.uid), log.node_names.end());
+    found_recovery |= log.node_names[transition.uid] == "Recovery";
+  }
+  ASSERT_TRUE(found_recovery);
+}
+
+// The executor should run many trees at once on its few threads
+TEST(TestBehaviorTree, ExecutorRunsTrees)
+{
+  ros2_behavior_tree::BehaviorTreeExecutor executor(2);
+  ASSERT_EQ(executor.num_threads(), 2u);
+
+  const int num_trees = 20;
+  std::vector<std::future<ros2_behavior_tree::BtStatus>> results;
+
+  for (int i = 0; i < num_trees; i++) {
+    auto bt = std::make_shared<ros2_behavior_tree::BehaviorTree>(xml_text);
+    bt->set_console_logging(false);
+
+    auto promise = std::make_shared<std::promise<ros2_behavior_tree::BtStatus>>();
+    results.push_back(promise->get_future());
+
+    ros2_behavior_tree::BehaviorTreeExecutor::Options options;
+    options.priority = i % 3;
+    executor.submit(bt,
+      [promise](ros2_behavior_tree::BtStatus status) {promise->set_value(status);},
+      options);
+  }
+
+  for (auto & result : results) {
+    ASSERT_EQ(result.get(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+  }
+  ASSERT_EQ(executor.size(), 0u);
+}
+
+// Trees on the executor should be ticked at their tick period and halted when asked
+TEST(TestBehaviorTree, ExecutorHaltsTrees)
+{
+  ros2_behavior_tree::BehaviorTreeExecutor executor(1);
+
+  auto bt = std::make_shared<ros2_behavior_tree::BehaviorTree>(forever_xml_text);
+  bt->set_console_logging(false);
+
+  std::atomic<int> ticks{0};
+  std::promise<ros2_behavior_tree::BtStatus> promise;
+
+  ros2_behavior_tree::BehaviorTreeExecutor::Options options;
+  options.tick_period = std::chrono::milliseconds(5);
+  options.should_halt = [&ticks]() {return ticks >= 10;};
+  options.on_loop_iteration = [&ticks]() {ticks++;};
+
+  auto start = std::chrono::steady_clock::now();
+  executor.submit(bt,
+    [&promise](ros2_behavior_tree::BtStatus status) {promise.set_value(status);},
+    options);
+
+  ASSERT_EQ(promise.get_future().get(), ros2_behavior_tree::BtStatus::HALTED);
+  ASSERT_EQ(ticks, 10);
+  ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(45));
+
+  // Trees still running when the executor is destroyed are halted
+  std::promise<ros2_behavior_tree::BtStatus> destroyed;
+  {
+    ros2_behavior_tree::BehaviorTreeExecutor short_lived(1);
+    short_lived.submit(bt,
+      [&destroyed](ros2_behavior_tree::BtStatus status) {destroyed.set_value(status);});
+  }
+  ASSERT_EQ(destroyed.get_future().get(), ros2_behavior_tree::BtStatus::HALTED);
+}
+
+// A tree that throws, when it is created or ticked, should fail without taking down the
+// executor's worker
+TEST(TestBehaviorTree, ExecutorFailsThrowingTrees)
+{
+  ros2_behavior_tree::BehaviorTreeExecutor executor(1);
+
+  // A port value that can't be converted, which throws when the tree is created, and an
+  // action client node without its required ports, which throws when it's ticked
+  static const char * bad_port_xml_text =
+    R"(
+ <root main_tree_to_execute = "MainTree" >
+     <BehaviorTree ID="MainTree">
+        <ComputePathToPose server_timeout="soon"/>
+     </BehaviorTree>
+ </root>
+ )";
+
+  static const char * missing_ports_xml_text =
+    R"(
+ <root main_tree_to_execute = "MainTree" >
+     <BehaviorTree ID="MainTree">
+        <ComputePathToPose/>
+     </BehaviorTree>
+ </root>
+ )";
+
+  for (auto text : {bad_port_xml_text, missing_ports_xml_text, xml_text}) {
+    auto bt = std::make_shared<ros2_behavior_tree::BehaviorTree>(text);
+    bt->set_console_logging(false);
+
+    std::promise<ros2_behavior_tree::BtStatus> promise;
+    executor.submit(bt,
+      [&promise](ros2_behavior_tree::BtStatus status) {promise.set_value(status);});
+
+    auto expected = text == xml_text ?
+      ros2_behavior_tree::BtStatus::SUCCEEDED : ros2_behavior_tree::BtStatus::FAILED;
+    ASSERT_EQ(promise.get_future().get(), expected);
+  }
+  ASSERT_EQ(executor.size(), 0u);
+}
+
+// A tree loaded from its compiled form should behave like the one created from the XML
+TEST(TestBehaviorTree, CompiledTree)
+{
+  std::string filename = "/tmp/test_behavior_tree_compiled.btc";
+
+  ros2_behavior_tree::BehaviorTree xml_bt(xml_text);
+  xml_bt.prepare();
+  std::string compiled = ros2_behavior_tree::CompiledTree::compile(*xml_bt.tree());
+  std::ofstream(filename, std::ios::binary).write(compiled.data(), compiled.size());
+
+  auto compiled_tree = std::make_shared<ros2_behavior_tree::CompiledTree>(filename);
+  std::remove(filename.c_str());
+  ASSERT_EQ(compiled_tree->node_count(), xml_bt.tree()->nodes.size());
+
+  ros2_behavior_tree::BehaviorTree bt(compiled_tree);
+  bt.prepare();
+
+  // The nodes and their ports should match, in the same order
+  ASSERT_EQ(bt.tree()->nodes.size(), xml_bt.tree()->nodes.size());
+  for (size_t i = 0; i < bt.tree()->nodes.size(); i++) {
+    const auto & node = bt.tree()->nodes[i];
+    const auto & xml_node = xml_bt.tree()->nodes[i];
+    ASSERT_EQ(node->registrationName(), xml_node->registrationName());
+    ASSERT_EQ(node->name(), xml_node->name());
+    ASSERT_EQ(node->config().input_ports, xml_node->config().input_ports);
+  }
+
+  ASSERT_EQ(bt.execute(), ros2_behavior_tree::BtStatus::SUCCEEDED);
+}
+
+// Loading something other than a compiled tree should fail
+TEST(TestBehaviorTree, InvalidCompiledTree)
+{
+  std::string filename = "/tmp/test_behavior_tree_invalid.btc";
+  std::ofstream(filename) << xml_text;
+
+  ASSERT_THROW(ros2_behavior_tree::CompiledTree tree(filename), BT::RuntimeError);
+  std::remove(filename.c_str());
+}
+
+int main(int argc, char ** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  rclcpp::init(argc, argv);
+  auto rc = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return rc;
+}
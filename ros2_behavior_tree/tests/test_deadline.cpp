@@ -0,0 +1,126 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "behaviortree_cpp_v3/behavior_tree.h"
+#include "ros2_behavior_tree/decorator/deadline_node.hpp"
+#include "ros2_behavior_tree/tick_deadline.hpp"
+#include "stub_action_test_node.hpp"
+
+using ros2_behavior_tree::TickDeadline;
+
+struct TestDeadlineNode : testing::Test
+{
+  TestDeadlineNode()
+  {
+    // Create a blackboard which will be shared among the nodes
+    blackboard_ = BT::Blackboard::create();
+
+    // Create a node configurand and populate the blackboard
+    BT::NodeConfiguration config;
+    config.blackboard = blackboard_;
+    blackboard_->set("msec", "100");
+
+    // Update the configuration with the child node's ports and tell the child node
+    // to use this configuration
+    BT::assignDefaultRemapping<StubActionTestNode>(config);
+    child_action_ = std::make_unique<StubActionTestNode>("child", config);
+
+    // Update the configuration with the parent node's ports and tell the parent node
+    // to use this configuration
+    BT::assignDefaultRemapping<ros2_behavior_tree::DeadlineNode>(config);
+    root_ = std::make_unique<ros2_behavior_tree::DeadlineNode>("deadline", config);
+
+    // Create the tree structure
+    root_->setChild(child_action_.get());
+  }
+
+  ~TestDeadlineNode()
+  {
+    BT::haltAllActions(root_.get());
+  }
+
+  std::unique_ptr<ros2_behavior_tree::DeadlineNode> root_;
+  std::unique_ptr<StubActionTestNode> child_action_;
+
+  BT::Blackboard::Ptr blackboard_;
+};
+
+TEST_F(TestDeadlineNode, ChildResultWithinBudget)
+{
+  // While the budget lasts, the parent returns whatever the child returns
+  child_action_->set_return_value(BT::NodeStatus::RUNNING);
+  ASSERT_EQ(root_->executeTick(), BT::NodeStatus::RUNNING);
+  ASSERT_EQ(child_action_->status(), BT::NodeStatus::RUNNING);
+
+  child_action_->set_return_value(BT::NodeStatus::SUCCESS);
+  ASSERT_EQ(root_->executeTick(), BT::NodeStatus::SUCCESS);
+  ASSERT_EQ(child_action_->get_tick_count(), 2);
+}
+
+TEST_F(TestDeadlineNode, FailureOnceBudgetRunsOut)
+{
+  child_action_->set_return_value(BT::NodeStatus::RUNNING);
+  ASSERT_EQ(root_->executeTick(), BT::NodeStatus::RUNNING);
+
+  // Wait a bit to exceed the budget
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+
+  // The child is halted, without being ticked again, and the parent fails
+  ASSERT_EQ(root_->executeTick(), BT::NodeStatus::FAILURE);
+  ASSERT_EQ(child_action_->status(), BT::NodeStatus::IDLE);
+  ASSERT_EQ(child_action_->get_tick_count(), 1);
+
+  // The next iteration starts with a fresh budget
+  child_action_->set_return_value(BT::NodeStatus::SUCCESS);
+  ASSERT_EQ(root_->executeTick(), BT::NodeStatus::SUCCESS);
+}
+
+TEST(TestTickDeadline, NestedScopes)
+{
+  using std::chrono::milliseconds;
+  auto now = TickDeadline::Clock::now();
+
+  // Without a deadline, timeouts are left alone
+  ASSERT_EQ(TickDeadline::current(), TickDeadline::Clock::time_point::max());
+  ASSERT_FALSE(TickDeadline::expired());
+  ASSERT_EQ(TickDeadline::clamp(milliseconds(5000)), milliseconds(5000));
+
+  {
+    TickDeadline::Scope outer(now + milliseconds(1000));
+    ASSERT_LE(TickDeadline::clamp(milliseconds(5000)), milliseconds(1000));
+    ASSERT_EQ(TickDeadline::clamp(milliseconds(10)), milliseconds(10));
+
+    {
+      // An inner deadline can't extend the outer one
+      TickDeadline::Scope inner(now + milliseconds(2000));
+      ASSERT_EQ(TickDeadline::current(), now + milliseconds(1000));
+    }
+
+    {
+      // But it can shorten it
+      TickDeadline::Scope inner(now - milliseconds(1));
+      ASSERT_TRUE(TickDeadline::expired());
+      ASSERT_EQ(TickDeadline::clamp(milliseconds(5000)), milliseconds(0));
+    }
+
+    ASSERT_EQ(TickDeadline::current(), now + milliseconds(1000));
+  }
+
+  ASSERT_EQ(TickDeadline::current(), TickDeadline::Clock::time_point::max());
+}
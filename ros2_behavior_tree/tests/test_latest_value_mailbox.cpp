@@ -0,0 +1,66 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "ros2_behavior_tree/latest_value_mailbox.hpp"
+
+TEST(LatestValueMailbox, KeepsLatestValue)
+{
+  ros2_behavior_tree::LatestValueMailbox<int> mailbox;
+  ASSERT_EQ(mailbox.take(), nullptr);
+
+  mailbox.post(std::make_shared<int>(1));
+  mailbox.post(std::make_shared<int>(2));
+  mailbox.post(std::make_shared<int>(3));
+
+  // Only the last value is delivered
+  auto value = mailbox.take();
+  ASSERT_NE(value, nullptr);
+  ASSERT_EQ(*value, 3);
+  ASSERT_EQ(mailbox.replaced(), 2u);
+
+  ASSERT_EQ(mailbox.take(), nullptr);
+}
+
+TEST(LatestValueMailbox, ConcurrentPostAndTake)
+{
+  ros2_behavior_tree::LatestValueMailbox<int> mailbox;
+  const int kNumValues = 100000;
+
+  std::atomic<bool> done{false};
+  std::thread producer([&]() {
+      for (int i = 1; i <= kNumValues; i++) {
+        mailbox.post(std::make_shared<int>(i));
+      }
+      done = true;
+    });
+
+  // The consumer sees increasing values and, eventually, the last one
+  int last = 0;
+  bool increasing = true;
+  while (!done || last != kNumValues) {
+    if (auto value = mailbox.take()) {
+      increasing = increasing && *value > last;
+      last = *value;
+    }
+  }
+
+  producer.join();
+  ASSERT_TRUE(increasing);
+  ASSERT_EQ(last, kNumValues);
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "behaviortree_cpp_v3/bt_factory.h"
+#include "ros2_behavior_tree/plugin_registry.hpp"
+#include "test_node_registrar.hpp"
+
+using ros2_behavior_tree::PluginRegistry;
+using ros2_behavior_tree::TestNodeRegistrar;
+
+// The test plugin (custom_test_nodes) provides two nodes
+static const size_t plugin_nodes = 2;
+
+// A plugin library should be loaded once, with later factories getting its nodes from the
+// registry's cache
+TEST(TestPluginRegistry, LoadsLibraryOnce)
+{
+  auto & registry = PluginRegistry::instance();
+  ASSERT_FALSE(registry.is_loaded("custom_test_nodes"));
+  ASSERT_EQ(TestNodeRegistrar::registrations(), 0);
+
+  BT::BehaviorTreeFactory factory1;
+  size_t builtin_nodes = factory1.builders().size();
+  registry.register_nodes(factory1, "custom_test_nodes");
+
+  ASSERT_TRUE(registry.is_loaded("custom_test_nodes"));
+  ASSERT_EQ(TestNodeRegistrar::registrations(), 1);
+  ASSERT_EQ(factory1.builders().size(), builtin_nodes + plugin_nodes);
+
+  // The second factory gets the cached builders and manifests without the library's
+  // registration function being run again. The factory registers its own built-in nodes,
+  // so registering them again from the cache would throw
+  BT::BehaviorTreeFactory factory2;
+  ASSERT_NO_THROW(registry.register_nodes(factory2, "custom_test_nodes"));
+  ASSERT_EQ(TestNodeRegistrar::registrations(), 1);
+  ASSERT_EQ(factory2.builders().size(), builtin_nodes + plugin_nodes);
+
+  for (const auto & id : {"AddTwoInts", "Fibonacci"}) {
+    ASSERT_EQ(factory2.builders().count(id), 1u);
+    const auto & manifest = factory2.manifests().at(id);
+    ASSERT_EQ(manifest.type, factory1.manifests().at(id).type);
+    ASSERT_EQ(manifest.ports.size(), factory1.manifests().at(id).ports.size());
+  }
+
+  // The cached builders create the plugin's nodes
+  BT::NodeConfiguration config;
+  config.blackboard = BT::Blackboard::create();
+  auto node = factory2.instantiateTreeNode("fibonacci", "Fibonacci", config);
+  ASSERT_NE(node, nullptr);
+  ASSERT_EQ(node->type(), BT::NodeType::ACTION);
+}
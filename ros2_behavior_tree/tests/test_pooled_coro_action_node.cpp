@@ -0,0 +1,153 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "behaviortree_cpp_v3/behavior_tree.h"
+#include "ros2_behavior_tree/coroutine_stack_pool.hpp"
+#include "ros2_behavior_tree/pooled_coro_action_node.hpp"
+
+using ros2_behavior_tree::CoroutineStackPool;
+
+// Yields a number of times before returning SUCCESS, or throwing if asked to. Counts the
+// destruction of a local, to check that halting unwinds the coroutine
+class YieldingNode : public ros2_behavior_tree::PooledCoroActionNode
+{
+public:
+  YieldingNode(const std::string & name, int yields)
+  : ros2_behavior_tree::PooledCoroActionNode(name, {}), yields_(yields)
+  {
+  }
+
+  ~YieldingNode()
+  {
+    halt();
+  }
+
+  BT::NodeStatus tick() override
+  {
+    auto local = std::shared_ptr<int>(new int(0), [this](int * p) {
+          destroyed_++;
+          delete p;
+        });
+
+    for (int i = 0; i < yields_; i++) {
+      setStatusRunningAndYield();
+    }
+
+    if (throw_) {
+      throw std::runtime_error("tick failed");
+    }
+    return BT::NodeStatus::SUCCESS;
+  }
+
+  int yields_;
+  bool throw_{false};
+  int destroyed_{0};
+};
+
+TEST(PooledCoroActionNode, YieldsAndCompletes)
+{
+  YieldingNode node("node", 3);
+
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(node.executeTick(), BT::NodeStatus::RUNNING);
+    ASSERT_EQ(node.status(), BT::NodeStatus::RUNNING);
+  }
+
+  ASSERT_EQ(node.executeTick(), BT::NodeStatus::SUCCESS);
+  ASSERT_EQ(node.destroyed_, 1);
+
+  // The node can run again
+  ASSERT_EQ(node.executeTick(), BT::NodeStatus::RUNNING);
+}
+
+TEST(PooledCoroActionNode, HaltUnwinds)
+{
+  YieldingNode node("node", 3);
+  auto in_use = CoroutineStackPool::instance().in_use();
+
+  ASSERT_EQ(node.executeTick(), BT::NodeStatus::RUNNING);
+  ASSERT_EQ(CoroutineStackPool::instance().in_use(), in_use + 1);
+
+  // Halting destroys the locals of the coroutine and gives its stack back
+  node.halt();
+  ASSERT_EQ(node.destroyed_, 1);
+  ASSERT_EQ(CoroutineStackPool::instance().in_use(), in_use);
+
+  // Starting over, the coroutine runs from the top
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(node.executeTick(), BT::NodeStatus::RUNNING);
+  }
+  ASSERT_EQ(node.executeTick(), BT::NodeStatus::SUCCESS);
+  ASSERT_EQ(node.destroyed_, 2);
+}
+
+TEST(PooledCoroActionNode, ExceptionsPropagate)
+{
+  YieldingNode node("node", 1);
+  node.throw_ = true;
+
+  ASSERT_EQ(node.executeTick(), BT::NodeStatus::RUNNING);
+  ASSERT_THROW(node.executeTick(), std::runtime_error);
+  ASSERT_EQ(node.destroyed_, 1);
+}
+
+TEST(CoroutineStackPool, ReusesStacks)
+{
+  auto & pool = CoroutineStackPool::instance();
+  pool.configure(CoroutineStackPool::Options());
+  auto created = pool.created();
+
+  // Nodes that run one after the other share a stack
+  std::vector<std::unique_ptr<YieldingNode>> nodes;
+  for (int i = 0; i < 10; i++) {
+    nodes.push_back(std::make_unique<YieldingNode>("node", 1));
+  }
+
+  for (auto & node : nodes) {
+    ASSERT_EQ(node->executeTick(), BT::NodeStatus::RUNNING);
+    ASSERT_EQ(node->executeTick(), BT::NodeStatus::SUCCESS);
+  }
+  ASSERT_EQ(pool.created(), created + 1);
+
+  // Nodes that run at the same time need a stack each
+  for (auto & node : nodes) {
+    ASSERT_EQ(node->executeTick(), BT::NodeStatus::RUNNING);
+  }
+  ASSERT_EQ(pool.in_use(), 10u);
+  ASSERT_EQ(pool.created(), created + 10);
+
+  nodes.clear();
+  ASSERT_EQ(pool.in_use(), 0u);
+  ASSERT_EQ(pool.free(), 10u);
+
+  // Stacks of a different size replace the free ones
+  CoroutineStackPool::Options options;
+  options.stack_size = 32 * 1024;
+  options.guard_page = false;
+  pool.configure(options);
+  ASSERT_EQ(pool.free(), 0u);
+
+  YieldingNode node("node", 1);
+  ASSERT_EQ(node.executeTick(), BT::NodeStatus::RUNNING);
+  ASSERT_EQ(node.executeTick(), BT::NodeStatus::SUCCESS);
+  ASSERT_EQ(pool.free(), 1u);
+
+  pool.configure(CoroutineStackPool::Options());
+}
@@ -0,0 +1,224 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "behaviortree_cpp_v3/action_node.h"
+#include "behaviortree_cpp_v3/behavior_tree.h"
+#include "ros2_behavior_tree/port_binding.hpp"
+#include "ros2_behavior_tree/shared_message.hpp"
+
+// A node whose ports are read and written through bindings
+class PortBindingTestNode : public BT::SyncActionNode
+{
+public:
+  PortBindingTestNode(const std::string & name, const BT::NodeConfiguration & config)
+  : BT::SyncActionNode(name, config),
+    remapped_input_(*this, "remapped"),
+    literal_input_(*this, "literal"),
+    unset_input_(*this, "unset"),
+    result_input_(*this, "result"),
+    shared_input_(*this, "shared"),
+    output_(*this, "output")
+  {
+  }
+
+  static BT::PortsList providedPorts()
+  {
+    return {
+      BT::InputPort<double>("remapped"),
+      BT::InputPort<int>("literal"),
+      BT::InputPort<double>("unset"),
+      BT::InputPort<double>("result"),
+      BT::InputPort("shared"),
+      BT::OutputPort<double>("output")
+    };
+  }
+
+  BT::NodeStatus tick() override
+  {
+    return BT::NodeStatus::SUCCESS;
+  }
+
+  ros2_behavior_tree::InputBinding<double> remapped_input_;
+  ros2_behavior_tree::InputBinding<int> literal_input_;
+  ros2_behavior_tree::InputBinding<double> unset_input_;
+  ros2_behavior_tree::InputBinding<double> result_input_;
+  ros2_behavior_tree::InputBinding<std::shared_ptr<const std::vector<double>>> shared_input_;
+  ros2_behavior_tree::OutputBinding<double> output_;
+};
+
+struct TestPortBinding : testing::Test
+{
+  TestPortBinding()
+  {
+    blackboard_ = BT::Blackboard::create();
+
+    BT::NodeConfiguration config;
+    config.blackboard = blackboard_;
+    config.input_ports["remapped"] = "{value}";
+    config.input_ports["literal"] = "42";
+    config.input_ports["result"] = "{result}";
+    config.input_ports["shared"] = "{shared}";
+    config.output_ports["output"] = "{result}";
+
+    node_ = std::make_unique<PortBindingTestNode>("node", config);
+  }
+
+  BT::Blackboard::Ptr blackboard_;
+  std::unique_ptr<PortBindingTestNode> node_;
+};
+
+TEST_F(TestPortBinding, RemappedInput)
+{
+  double value = 0.0;
+
+  // The entry doesn't exist until something writes it
+  ASSERT_TRUE(node_->remapped_input_.is_bound());
+  ASSERT_FALSE(node_->remapped_input_.get(value));
+
+  blackboard_->set<double>("value", 1.5);
+  ASSERT_TRUE(node_->remapped_input_.get(value));
+  ASSERT_EQ(value, 1.5);
+
+  // Later writes to the blackboard are seen through the cached entry
+  blackboard_->set<double>("value", 2.5);
+  ASSERT_TRUE(node_->remapped_input_.get(value));
+  ASSERT_EQ(value, 2.5);
+}
+
+// A string entry, such as one written by SetBlackboard, is converted as getInput() does
+TEST_F(TestPortBinding, StringEntry)
+{
+  double value = 0.0;
+
+  blackboard_->set<std::string>("value", "2.5");
+  ASSERT_TRUE(node_->remapped_input_.get(value));
+  ASSERT_EQ(value, 2.5);
+
+  // A string that can't be converted isn't a value
+  blackboard_->set<std::string>("value", "two and a half");
+  ASSERT_FALSE(node_->remapped_input_.get(value));
+  ASSERT_EQ(value, 2.5);
+}
+
+// A port of a shared message also reads the plain message, as a copy
+TEST_F(TestPortBinding, SharedMessageFromValue)
+{
+  std::shared_ptr<const std::vector<double>> value;
+
+  blackboard_->set("shared", std::vector<double>(3, 1.5));
+  ASSERT_TRUE(node_->shared_input_.get(value));
+  ASSERT_NE(value, nullptr);
+  ASSERT_EQ(*value, std::vector<double>(3, 1.5));
+}
+
+TEST_F(TestPortBinding, LiteralAndMissingInputs)
+{
+  int literal = 0;
+  ASSERT_TRUE(node_->literal_input_.is_literal());
+  ASSERT_TRUE(node_->literal_input_.get(literal));
+  ASSERT_EQ(literal, 42);
+
+  double unset = 0.0;
+  ASSERT_FALSE(node_->unset_input_.is_bound());
+  ASSERT_FALSE(node_->unset_input_.get(unset));
+}
+
+TEST_F(TestPortBinding, Output)
+{
+  double result = 0.0;
+
+  ASSERT_TRUE(node_->output_.set(3.0));
+  ASSERT_TRUE(blackboard_->get<double>("result", result));
+  ASSERT_EQ(result, 3.0);
+
+  // The second write goes straight to the cached entry
+  ASSERT_TRUE(node_->output_.set(4.0));
+  ASSERT_TRUE(blackboard_->get<double>("result", result));
+  ASSERT_EQ(result, 4.0);
+}
+
+TEST_F(TestPortBinding, InvalidLiteral)
+{
+  BT::NodeConfiguration config;
+  config.blackboard = blackboard_;
+  config.input_ports["literal"] = "forty-two";
+
+  // A literal that can't be converted is reported when the node is created
+  ASSERT_THROW(PortBindingTestNode("node", config), BT::RuntimeError);
+}
+
+TEST_F(TestPortBinding, Versions)
+{
+  double result = 0.0;
+  uint64_t version = 0;
+
+  // Nothing has been written through an output binding yet
+  ASSERT_EQ(node_->result_input_.version(), 0u);
+
+  ASSERT_TRUE(node_->output_.set(1.0));
+  ASSERT_EQ(node_->result_input_.version(), 1u);
+  ASSERT_TRUE(node_->result_input_.get_if_changed(result, version));
+  ASSERT_EQ(result, 1.0);
+  ASSERT_EQ(version, 1u);
+
+  // Nothing new to read until the next write, even if it's the same value
+  ASSERT_FALSE(node_->result_input_.get_if_changed(result, version));
+  ASSERT_TRUE(node_->output_.set(1.0));
+  ASSERT_TRUE(node_->result_input_.get_if_changed(result, version));
+  ASSERT_EQ(version, 2u);
+}
+
+TEST_F(TestPortBinding, UnversionedChanges)
+{
+  double value = 0.0;
+  uint64_t version = 0;
+
+  // Values written directly to the blackboard aren't versioned, so they're compared
+  blackboard_->set<double>("value", 1.5);
+  ASSERT_EQ(node_->remapped_input_.version(), 0u);
+  ASSERT_TRUE(node_->remapped_input_.get_if_changed(value, version));
+  ASSERT_EQ(value, 1.5);
+  ASSERT_FALSE(node_->remapped_input_.get_if_changed(value, version));
+
+  blackboard_->set<double>("value", 2.5);
+  ASSERT_TRUE(node_->remapped_input_.get_if_changed(value, version));
+  ASSERT_EQ(value, 2.5);
+}
+
+TEST(SharedMessage, ShareMember)
+{
+  struct Result
+  {
+    std::vector<double> path;
+  };
+
+  auto result = std::make_shared<Result>();
+  result->path.resize(1000);
+
+  // The member keeps the whole result alive, without a copy of it being made
+  auto path = ros2_behavior_tree::share_member(result, result->path);
+  ASSERT_EQ(path.get(), &result->path);
+
+  std::weak_ptr<Result> weak_result = result;
+  result.reset();
+  ASSERT_FALSE(weak_result.expired());
+
+  path.reset();
+  ASSERT_TRUE(weak_result.expired());
+}
@@ -14,14 +14,20 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "fibonacci_client.hpp"
 #include "fibonacci_server.hpp"
+#include "ros2_behavior_tree/action_server_discovery.hpp"
 #include "ros2_behavior_tree/behavior_tree.hpp"
+#include "ros2_behavior_tree/client_pool.hpp"
 #include "ros2_behavior_tree/node_thread.hpp"
+#include "ros2_behavior_tree/pending_cancels.hpp"
 #include "ros2_behavior_tree/ros2_service_client_node.hpp"
 #include "rclcpp/rclcpp.hpp"
 
@@ -124,9 +130,19 @@ TEST_F(TestROS2ActionClientNode, CallUsingXML)
   ros2_behavior_tree::BehaviorTree bt(xml_text, {"ros2_behavior_tree_nodes", "custom_test_nodes"});
 
   // Execute the Behavior Tree and make sure that was successful
+  auto goals = bt.action_latency("fibonacci")->goals.load();
   auto bt_result = bt.execute();
   ASSERT_EQ(bt_result, ros2_behavior_tree::BtStatus::SUCCEEDED);
 
+  // The goal's latencies were recorded
+  auto latency = bt.action_latency("fibonacci");
+  ASSERT_EQ(latency->goals, goals + 1);
+  ASSERT_GE(latency->goal_response.count(), 1u);
+  ASSERT_GE(latency->first_feedback.count(), 1u);
+  ASSERT_GE(latency->execution.count(), 1u);
+  ASSERT_GE(latency->result_pickup.count(), 1u);
+  ASSERT_GT(latency->execution.max(), std::chrono::nanoseconds(0));
+
   // Check the resulting value from the 'sequence' output port
 
   std::vector<int32_t> sequence;
@@ -163,6 +179,138 @@ TEST_F(TestROS2ActionClientNode, SendNewGoal)
   ASSERT_EQ(sequence, expected_result);
 }
 
+TEST_F(TestROS2ActionClientNode, TicksDontBlock)
+{
+  blackboard_->set("action_name", "fibonacci");
+  blackboard_->set("server_timeout", "5000");
+  blackboard_->set<std::shared_ptr<rclcpp::Node>>("ros2_node", ros2_node_);  // NOLINT
+  blackboard_->set("n", "4");
+
+  // The first tick waits for the action server, so leave it out
+  auto status = fibonacci_client_->executeTick();
+
+  // While the goal is in progress, each tick should yield right away rather than wait on
+  // the server for up to server_timeout
+  auto longest_tick = std::chrono::steady_clock::duration::zero();
+  while (status == BT::NodeStatus::RUNNING) {
+    auto start = std::chrono::steady_clock::now();
+    status = fibonacci_client_->executeTick();
+    longest_tick = std::max(longest_tick, std::chrono::steady_clock::now() - start);
+  }
+
+  ASSERT_EQ(status, BT::NodeStatus::SUCCESS);
+  ASSERT_LT(longest_tick, std::chrono::milliseconds(100));
+}
+
+TEST_F(TestROS2ActionClientNode, HaltDoesntBlock)
+{
+  blackboard_->set("action_name", "fibonacci");
+  blackboard_->set("server_timeout", "5000");
+  blackboard_->set<std::shared_ptr<rclcpp::Node>>("ros2_node", ros2_node_);  // NOLINT
+  blackboard_->set("n", "20");
+
+  auto pending_cancels = std::make_shared<ros2_behavior_tree::PendingCancels>();
+  auto statistics = ros2_behavior_tree::ActionLatencyRegistry::instance().get("fibonacci");
+  auto cancels = statistics->cancel.count();
+
+  // Get the goal going, with the node picking up the pending cancels as it's ticked
+  {
+    ros2_behavior_tree::PendingCancels::Scope scope(pending_cancels);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (std::chrono::steady_clock::now() < deadline) {
+      ASSERT_EQ(fibonacci_client_->executeTick(), BT::NodeStatus::RUNNING);
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  // Halting should send the cancel request without waiting for it to be acknowledged
+  auto start = std::chrono::steady_clock::now();
+  fibonacci_client_->halt();
+  auto halt_time = std::chrono::steady_clock::now() - start;
+  ASSERT_LT(halt_time, std::chrono::milliseconds(50));
+
+  // The acknowledgement arrives in the background
+  ASSERT_TRUE(pending_cancels->wait_all(std::chrono::milliseconds(2000)));
+  ASSERT_EQ(pending_cancels->pending(), 0u);
+  ASSERT_EQ(statistics->cancel.count(), cancels + 1);
+}
+
+TEST_F(TestROS2ActionClientNode, HaltBeforeGoalResponse)
+{
+  blackboard_->set("action_name", "fibonacci");
+  blackboard_->set("server_timeout", "5000");
+  blackboard_->set<std::shared_ptr<rclcpp::Node>>("ros2_node", ros2_node_);  // NOLINT
+  blackboard_->set("n", "20");
+
+  auto pending_cancels = std::make_shared<ros2_behavior_tree::PendingCancels>();
+  auto statistics = ros2_behavior_tree::ActionLatencyRegistry::instance().get("fibonacci");
+  auto goals = statistics->goals.load();
+  auto cancels = statistics->cancel.count();
+
+  // Tick until the goal has been sent, which leaves the node waiting for the server to
+  // respond to it
+  {
+    ros2_behavior_tree::PendingCancels::Scope scope(pending_cancels);
+    while (statistics->goals == goals) {
+      ASSERT_EQ(fibonacci_client_->executeTick(), BT::NodeStatus::RUNNING);
+    }
+  }
+
+  // There's no goal handle yet, so the goal is canceled once the server accepts it
+  fibonacci_client_->halt();
+  ASSERT_TRUE(pending_cancels->wait_all(std::chrono::milliseconds(2000)));
+  ASSERT_EQ(pending_cancels->pending(), 0u);
+  ASSERT_EQ(statistics->cancel.count(), cancels + 1);
+
+  // The node can be run again after being halted
+  blackboard_->set("n", "4");
+  BT::NodeStatus status;
+  while ((status = fibonacci_client_->executeTick()) == BT::NodeStatus::RUNNING) {
+  }
+  ASSERT_EQ(status, BT::NodeStatus::SUCCESS);
+}
+
+TEST_F(TestROS2ActionClientNode, ActionServerDiscovery)
+{
+  auto & discovery = ros2_behavior_tree::ActionServerDiscovery::instance();
+  ASSERT_EQ(discovery.resolve_name(ros2_node_, "fibonacci"), "/fibonacci");
+  ASSERT_EQ(discovery.resolve_name(ros2_node_, "/ns/fibonacci"), "/ns/fibonacci");
+
+  // The server was started before the test, but may take a moment to show up in the graph
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!discovery.is_available(ros2_node_, "fibonacci") &&
+    std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  ASSERT_TRUE(discovery.is_available(ros2_node_, "fibonacci"));
+  ASSERT_FALSE(discovery.is_available(ros2_node_, "no_such_action"));
+  ASSERT_EQ(discovery.prewarm(ros2_node_, {"fibonacci", "no_such_action"}), 1u);
+}
+
+TEST_F(TestROS2ActionClientNode, ClientPool)
+{
+  auto & pool = ros2_behavior_tree::ClientPool::instance();
+  auto created = pool.created();
+
+  // Requests for the same node and action share a client
+  auto client1 = pool.get_action_client<Fibonacci>(ros2_node_, "fibonacci");
+  auto client2 = pool.get_action_client<Fibonacci>(ros2_node_, "fibonacci");
+  ASSERT_EQ(client1, client2);
+
+  // A different action name gets its own client
+  auto client3 = pool.get_action_client<Fibonacci>(ros2_node_, "fibonacci2");
+  ASSERT_NE(client1, client3);
+  ASSERT_EQ(pool.created(), created + 2);
+
+  // Once nothing is using a client, the next request creates a new one
+  client1.reset();
+  client2.reset();
+  auto client4 = pool.get_action_client<Fibonacci>(ros2_node_, "fibonacci");
+  ASSERT_EQ(pool.created(), created + 3);
+}
+
 int main(int argc, char ** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -16,11 +16,18 @@
 
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "add_two_ints_client.hpp"
 #include "add_two_ints_server.hpp"
+#include "add_two_ints_sync_client.hpp"
 #include "ros2_behavior_tree/behavior_tree.hpp"
+#include "ros2_behavior_tree/client_pool.hpp"
+#include "ros2_behavior_tree/executor_service.hpp"
 #include "ros2_behavior_tree/node_thread.hpp"
+#include "ros2_behavior_tree/request_coalescer.hpp"
+#include "ros2_behavior_tree/response_cache.hpp"
 #include "ros2_behavior_tree/ros2_service_client_node.hpp"
 #include "rclcpp/rclcpp.hpp"
 
@@ -152,6 +159,236 @@ TEST_F(TestROS2ServiceClientNode, ChainUsingXMLAndPorts)
   ASSERT_EQ(sum3, 252);
 }
 
+// Identical requests made within the batch window should share one call to the server
+TEST_F(TestROS2ServiceClientNode, CoalescedRequests)
+{
+  auto & coalescer = ros2_behavior_tree::RequestCoalescer::instance();
+  auto client = ros2_behavior_tree::ClientPool::instance().get_service_client<AddTwoInts>(
+    ros2_node_, "add_two_ints");
+  ASSERT_TRUE(client->wait_for_service(std::chrono::seconds(1)));
+
+  auto requests = coalescer.requests();
+  auto round_trips = coalescer.round_trips();
+
+  auto request = std::make_shared<AddTwoInts::Request>();
+  request->a = 2;
+  request->b = 3;
+
+  std::vector<ros2_behavior_tree::RequestCoalescer::Handle<AddTwoInts>> handles;
+  for (int i = 0; i < 5; i++) {
+    handles.push_back(coalescer.send_request(client, request, std::chrono::milliseconds(50)));
+  }
+
+  for (auto & handle : handles) {
+    ASSERT_EQ(handle.future.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    ASSERT_EQ(handle.future.get()->sum, 5);
+  }
+
+  ASSERT_EQ(coalescer.requests(), requests + 5);
+  ASSERT_EQ(coalescer.round_trips(), round_trips + 1);
+
+  // A different request gets its own call
+  request->b = 4;
+  auto handle = coalescer.send_request(client, request);
+  ASSERT_EQ(handle.future.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+  ASSERT_EQ(handle.future.get()->sum, 6);
+  ASSERT_EQ(coalescer.round_trips(), round_trips + 2);
+
+  // The node gets the same result whether or not it coalesces its requests
+  blackboard_->set("a", 33);
+  blackboard_->set("b", 44);
+  blackboard_->set("coalesce", true);
+  ASSERT_EQ(add_two_ints_client_->executeTick(), BT::NodeStatus::SUCCESS);
+
+  int64_t sum = 0;
+  ASSERT_TRUE(blackboard_->get("sum", sum));
+  ASSERT_EQ(sum, 77);
+  ASSERT_EQ(coalescer.round_trips(), round_trips + 3);
+}
+
+// A call is sent, and stays shared, as long as one of the requests sharing it is waiting
+TEST_F(TestROS2ServiceClientNode, AbandonedCoalescedRequest)
+{
+  auto & coalescer = ros2_behavior_tree::RequestCoalescer::instance();
+  auto client = ros2_behavior_tree::ClientPool::instance().get_service_client<AddTwoInts>(
+    ros2_node_, "add_two_ints");
+  ASSERT_TRUE(client->wait_for_service(std::chrono::seconds(1)));
+
+  auto round_trips = coalescer.round_trips();
+
+  auto request = std::make_shared<AddTwoInts::Request>();
+  request->a = 5;
+  request->b = 8;
+
+  // Give up on one of the requests before the batch window has passed
+  std::vector<ros2_behavior_tree::RequestCoalescer::Handle<AddTwoInts>> handles;
+  for (int i = 0; i < 3; i++) {
+    handles.push_back(coalescer.send_request(client, request, std::chrono::milliseconds(100)));
+  }
+  coalescer.abandon(handles[0].call);
+
+  // A request made after that still joins the call
+  handles.push_back(coalescer.send_request(client, request, std::chrono::milliseconds(100)));
+  ASSERT_EQ(coalescer.round_trips(), round_trips + 1);
+
+  for (size_t i = 1; i < handles.size(); i++) {
+    ASSERT_EQ(handles[i].future.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    ASSERT_EQ(handles[i].future.get()->sum, 13);
+  }
+
+  // Once every request sharing a call has given up on it, the next one gets a new call
+  request->b = 9;
+  auto first = coalescer.send_request(client, request, std::chrono::milliseconds(100));
+  auto second = coalescer.send_request(client, request, std::chrono::milliseconds(100));
+  coalescer.abandon(first.call);
+  coalescer.abandon(second.call);
+
+  auto third = coalescer.send_request(client, request);
+  ASSERT_NE(third.call, first.call);
+  ASSERT_EQ(third.future.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+  ASSERT_EQ(third.future.get()->sum, 14);
+  ASSERT_EQ(coalescer.round_trips(), round_trips + 3);
+}
+
+// With a cache TTL, an identical request is answered from the cache until it expires
+TEST_F(TestROS2ServiceClientNode, CachedResponses)
+{
+  auto & cache = ros2_behavior_tree::ResponseCache::instance();
+  cache.clear();
+  auto before = cache.statistics();
+
+  blackboard_->set("a", 10);
+  blackboard_->set("b", 20);
+  blackboard_->set("cache_ttl", "200");
+
+  auto call = [this]() {
+      auto status = add_two_ints_client_->executeTick();
+      while (status == BT::NodeStatus::RUNNING) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        status = add_two_ints_client_->executeTick();
+      }
+      int64_t sum = 0;
+      blackboard_->get("sum", sum);
+      return status == BT::NodeStatus::SUCCESS ? sum : -1;
+    };
+
+  // The first call goes to the server, the second comes from the cache without a tick
+  // of RUNNING in between
+  ASSERT_EQ(call(), 30);
+  ASSERT_EQ(add_two_ints_client_->executeTick(), BT::NodeStatus::SUCCESS);
+  int64_t sum = 0;
+  ASSERT_TRUE(blackboard_->get("sum", sum));
+  ASSERT_EQ(sum, 30);
+
+  auto statistics = cache.statistics();
+  ASSERT_EQ(statistics.hits, before.hits + 1);
+  ASSERT_EQ(statistics.misses, before.misses + 1);
+  ASSERT_EQ(statistics.size, 1u);
+
+  // A different request isn't answered from the cache
+  blackboard_->set("b", 21);
+  ASSERT_EQ(call(), 31);
+  ASSERT_EQ(cache.statistics().misses, before.misses + 2);
+
+  // Once the response expires, the request goes to the server again
+  std::this_thread::sleep_for(std::chrono::milliseconds(250));
+  blackboard_->set("b", 20);
+  ASSERT_EQ(call(), 30);
+  ASSERT_EQ(cache.statistics().expirations, before.expirations + 1);
+
+  // From a node in another namespace, the same service name resolves to another service,
+  // so the request isn't answered from the cache (and there's no server for it)
+  auto other_node = std::make_shared<rclcpp::Node>("other_node", "other");
+  blackboard_->set<std::shared_ptr<rclcpp::Node>>("ros2_node", other_node);  // NOLINT
+  blackboard_->set("server_timeout", "100");
+  ASSERT_EQ(call(), -1);
+  ASSERT_EQ(cache.statistics().hits, before.hits + 1);
+}
+
+// In non-blocking mode, the synchronous node returns RUNNING while the call is outstanding
+// instead of holding up the tick
+TEST_F(TestROS2ServiceClientNode, NonBlockingCall)
+{
+  BT::NodeConfiguration config;
+  config.blackboard = blackboard_;
+  BT::assignDefaultRemapping<AddTwoIntsSyncClient>(config);
+  auto client = std::make_unique<AddTwoIntsSyncClient>("add_two_ints_sync", config);
+
+  blackboard_->set("a", 12);
+  blackboard_->set("b", 30);
+  blackboard_->set("non_blocking", true);
+
+  auto tick = [&client]() {
+      auto start = std::chrono::steady_clock::now();
+      auto status = client->executeTick();
+      EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+      return status;
+    };
+
+  auto status = tick();
+  while (status == BT::NodeStatus::RUNNING) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    status = tick();
+  }
+  ASSERT_EQ(status, BT::NodeStatus::SUCCESS);
+
+  int64_t sum = 0;
+  ASSERT_TRUE(blackboard_->get("sum", sum));
+  ASSERT_EQ(sum, 42);
+
+  // A service that isn't there keeps the node RUNNING until the server timeout
+  blackboard_->set("service_name", "no_such_service");
+  blackboard_->set("server_timeout", "200");
+
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_EQ(tick(), BT::NodeStatus::RUNNING);
+  do {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    status = tick();
+  } while (status == BT::NodeStatus::RUNNING);
+  ASSERT_EQ(status, BT::NodeStatus::FAILURE);
+  ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+
+  // Halting drops the outstanding call, so the next tick starts a new one
+  blackboard_->set("service_name", "add_two_ints");
+  blackboard_->set("b", 31);
+  tick();
+  client->halt();
+  ASSERT_EQ(client->status(), BT::NodeStatus::IDLE);
+
+  do {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    status = tick();
+  } while (status == BT::NodeStatus::RUNNING);
+  ASSERT_EQ(status, BT::NodeStatus::SUCCESS);
+  ASSERT_TRUE(blackboard_->get("sum", sum));
+  ASSERT_EQ(sum, 43);
+}
+
+// A node spun by the ExecutorService gets its responses like one with a NodeThread
+TEST_F(TestROS2ServiceClientNode, SharedExecutor)
+{
+  auto & service = ros2_behavior_tree::ExecutorService::instance();
+  auto size = service.size();
+
+  auto node = std::make_shared<rclcpp::Node>("shared_executor_node");
+  auto registration = service.add_node(node);
+  ASSERT_EQ(service.size(), size + 1);
+
+  auto client = node->create_client<AddTwoInts>("add_two_ints");
+  ASSERT_TRUE(client->wait_for_service(std::chrono::seconds(1)));
+
+  auto request = std::make_shared<AddTwoInts::Request>();
+  request->a = 5;
+  request->b = 8;
+  auto future_result = client->async_send_request(request);
+  ASSERT_EQ(future_result.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+  ASSERT_EQ(future_result.get()->sum, 13);
+
+  registration.reset();
+  ASSERT_EQ(service.size(), size);
+}
+
 int main(int argc, char ** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
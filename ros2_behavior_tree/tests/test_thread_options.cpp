@@ -0,0 +1,97 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+#include "behaviortree_cpp_v3/exceptions.h"
+#include "ros2_behavior_tree/thread_options.hpp"
+
+using ros2_behavior_tree::ThreadOptions;
+using ros2_behavior_tree::apply_thread_options;
+using ros2_behavior_tree::parse_cpu_list;
+
+TEST(TestThreadOptions, ParseCpuList)
+{
+  ASSERT_EQ(parse_cpu_list(""), std::vector<int>());
+  ASSERT_EQ(parse_cpu_list("3"), std::vector<int>({3}));
+  ASSERT_EQ(parse_cpu_list("0-2,6"), std::vector<int>({0, 1, 2, 6}));
+  ASSERT_THROW(parse_cpu_list("2-1"), BT::RuntimeError);
+  ASSERT_THROW(parse_cpu_list("a"), BT::RuntimeError);
+}
+
+// Pin a thread to the CPU it's running on, which is always allowed
+TEST(TestThreadOptions, Affinity)
+{
+  std::thread thread([]() {
+      ThreadOptions options;
+      options.cpus = {sched_getcpu()};
+      ASSERT_TRUE(apply_thread_options(options));
+
+      cpu_set_t cpu_set;
+      ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set), 0);
+      ASSERT_EQ(CPU_COUNT(&cpu_set), 1);
+      ASSERT_TRUE(CPU_ISSET(options.cpus[0], &cpu_set));
+    });
+  thread.join();
+}
+
+// Raising the nice value of a thread is always allowed, and only affects that thread
+TEST(TestThreadOptions, Nice)
+{
+  auto nice_value = []() {
+      return getpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)));
+    };
+  auto before = nice_value();
+
+  std::thread thread([&]() {
+      ThreadOptions options;
+      options.nice = before + 1;
+      ASSERT_TRUE(apply_thread_options(options));
+      ASSERT_EQ(nice_value(), before + 1);
+    });
+  thread.join();
+
+  ASSERT_EQ(nice_value(), before);
+}
+
+// SCHED_FIFO usually needs privileges the test doesn't have. Either way, the thread keeps
+// running, falling back to the nice value if it can't have SCHED_FIFO
+TEST(TestThreadOptions, FifoPriority)
+{
+  std::thread thread([]() {
+      ThreadOptions options;
+      options.fifo_priority = 10;
+      options.nice = 1;
+      bool applied = apply_thread_options(options);
+
+      int policy;
+      sched_param param;
+      ASSERT_EQ(pthread_getschedparam(pthread_self(), &policy, &param), 0);
+      if (applied) {
+        ASSERT_EQ(policy, SCHED_FIFO);
+        ASSERT_EQ(param.sched_priority, 10);
+      } else {
+        ASSERT_EQ(policy, SCHED_OTHER);
+      }
+    });
+  thread.join();
+}
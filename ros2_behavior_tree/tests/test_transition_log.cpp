@@ -0,0 +1,107 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+
+#include "ros2_behavior_tree/spsc_ring.hpp"
+#include "ros2_behavior_tree/transition_log.hpp"
+
+using ros2_behavior_tree::SpscRing;
+using ros2_behavior_tree::TransitionLogWriter;
+using ros2_behavior_tree::TransitionRecord;
+
+static std::string
+temp_log_filename()
+{
+  return "/tmp/test_transition_log_" + std::to_string(::getpid()) + ".bin";
+}
+
+// The ring should reject items when it is full and hand them back out in order
+TEST(TestTransitionLog, SpscRing)
+{
+  SpscRing<int> ring(3);
+  ASSERT_EQ(ring.capacity(), 4u);
+
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(ring.push(i));
+  }
+  ASSERT_FALSE(ring.push(4));
+
+  int items[8];
+  ASSERT_EQ(ring.pop(items, 3), 3u);
+  ASSERT_EQ(items[0], 0);
+  ASSERT_EQ(items[2], 2);
+
+  ASSERT_TRUE(ring.push(5));
+  ASSERT_EQ(ring.pop(items, 8), 2u);
+  ASSERT_EQ(items[0], 3);
+  ASSERT_EQ(items[1], 5);
+  ASSERT_TRUE(ring.empty());
+}
+
+// Everything recorded by the writer should be read back from the file
+TEST(TestTransitionLog, WriteAndRead)
+{
+  auto filename = temp_log_filename();
+  {
+    TransitionLogWriter writer(filename);
+    writer.add_node_name(1, "root");
+    writer.add_node_name(2, "a node with a name longer than one record");
+    writer.add_node_name(1, "root again");
+
+    for (int i = 0; i < 1000; i++) {
+      TransitionRecord record{};
+      record.timestamp_ns = i;
+      record.uid = 1 + i % 2;
+      record.prev_status = 0;
+      record.status = 1;
+      writer.record(record);
+    }
+
+    // A flushed log can be read while the writer is still open
+    writer.flush();
+    auto log = ros2_behavior_tree::read_transition_log(filename);
+    ASSERT_EQ(log.transitions.size() + writer.dropped(), 1000u);
+  }
+
+  auto log = ros2_behavior_tree::read_transition_log(filename);
+  std::remove(filename.c_str());
+
+  ASSERT_EQ(log.node_names.size(), 2u);
+  ASSERT_EQ(log.node_names[1], "root");
+  ASSERT_EQ(log.node_names[2], "a node with a name longer than one record");
+  ASSERT_EQ(log.transitions.size() + log.header.dropped, 1000u);
+
+  for (size_t i = 1; i < log.transitions.size(); i++) {
+    ASSERT_LT(log.transitions[i - 1].timestamp_ns, log.transitions[i].timestamp_ns);
+  }
+}
+
+// Reading something other than a transition log should fail
+TEST(TestTransitionLog, ReadInvalidFile)
+{
+  ASSERT_ANY_THROW(ros2_behavior_tree::read_transition_log("/nonexistent/transition.log"));
+
+  auto filename = temp_log_filename();
+  FILE * file = std::fopen(filename.c_str(), "w");
+  std::fputs("this is not a transition log, but it is long enough to have a header", file);
+  std::fclose(file);
+
+  ASSERT_ANY_THROW(ros2_behavior_tree::read_transition_log(filename));
+  std::remove(filename.c_str());
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compile a Behavior Tree XML file into the binary format loaded by CompiledTree, so that
+// the XML doesn't have to be parsed at startup. The node types are checked against the
+// specified plugin libraries, which must be the same ones used to load the compiled tree
+
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ros2_behavior_tree/behavior_tree.hpp"
+#include "ros2_behavior_tree/compiled_tree.hpp"
+
+int main(int argc, char ** argv)
+{
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <input xml> <output file> [plugin library ...]\n", argv[0]);
+    return 1;
+  }
+
+  std::ifstream input(argv[1]);
+  if (!input) {
+    fprintf(stderr, "Could not read %s\n", argv[1]);
+    return 1;
+  }
+
+  std::stringstream bt_xml;
+  bt_xml << input.rdbuf();
+
+  std::vector<std::string> plugin_library_names(argv + 3, argv + argc);
+  if (plugin_library_names.empty()) {
+    plugin_library_names.push_back("ros2_behavior_tree_nodes");
+  }
+
+  std::string compiled;
+  unsigned int node_count = 0;
+  try {
+    // Instantiate the tree the same way BehaviorTree does, so that the compiled tree gets
+    // exactly the same nodes, remappings and default port values
+    ros2_behavior_tree::BehaviorTree bt(bt_xml.str(), plugin_library_names);
+    bt.prepare();
+    compiled = ros2_behavior_tree::CompiledTree::compile(*bt.tree());
+    node_count = bt.tree()->nodes.size();
+  } catch (const std::exception & ex) {
+    fprintf(stderr, "%s: %s\n", argv[1], ex.what());
+    return 1;
+  }
+
+  std::ofstream output(argv[2], std::ios::binary);
+  output.write(compiled.data(), compiled.size());
+  if (!output) {
+    fprintf(stderr, "Could not write %s\n", argv[2]);
+    return 1;
+  }
+
+  printf("Compiled %u nodes into %s (%zu bytes)\n", node_count, argv[2], compiled.size());
+  return 0;
+}
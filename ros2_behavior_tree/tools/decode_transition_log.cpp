@@ -0,0 +1,70 @@
+// Copyright (c) 2019 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Print a binary transition log, as written by BinaryTransitionLogger, as text in the
+// same format as BT::StdCoutLogger
+
+#include <cstdio>
+#include <exception>
+#include <string>
+
+#include "ros2_behavior_tree/transition_log.hpp"
+
+static const char *
+status_name(uint8_t status)
+{
+  switch (status) {
+    case 0: return "IDLE";
+    case 1: return "RUNNING";
+    case 2: return "SUCCESS";
+    case 3: return "FAILURE";
+    default: return "UNKNOWN";
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <transition log file>\n", argv[0]);
+    return 1;
+  }
+
+  ros2_behavior_tree::TransitionLog log;
+  try {
+    log = ros2_behavior_tree::read_transition_log(argv[1]);
+  } catch (const std::exception & ex) {
+    fprintf(stderr, "%s\n", ex.what());
+    return 1;
+  }
+
+  // Timestamps are shown relative to the first transition
+  int64_t first = log.transitions.empty() ? 0 : log.transitions.front().timestamp_ns;
+
+  for (const auto & transition : log.transitions) {
+    auto it = log.node_names.find(transition.uid);
+    std::string name = it != log.node_names.end() ?
+      it->second : "uid " + std::to_string(transition.uid);
+
+    printf("[%.3f]: %-25s %-8s -> %s\n",
+      (transition.timestamp_ns - first) / 1e9, name.c_str(),
+      status_name(transition.prev_status), status_name(transition.status));
+  }
+
+  if (log.header.dropped > 0) {
+    fprintf(stderr, "%llu transitions were dropped while logging\n",
+      static_cast<unsigned long long>(log.header.dropped));  // NOLINT
+  }
+
+  return 0;
+}